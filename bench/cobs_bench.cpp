@@ -0,0 +1,89 @@
+// Host benchmark of the COBS encoder and decoder. Not part of the firmware (bench/ is not an EIDE source folder).
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Isrc bench/cobs_bench.cpp -o /tmp/cobs_bench && /tmp/cobs_bench
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <stpp/cobs.hpp>
+
+namespace
+{
+    constexpr std::size_t kTotalBytes   = 64 * 1024 * 1024; // Payload bytes processed per measurement
+    constexpr std::size_t kPacketLength = 256;
+
+    double GetSeconds()
+    {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    std::vector<uint8_t> MakePayload(std::size_t length, unsigned zero_one_in)
+    {
+        std::vector<uint8_t> payload(length);
+        std::srand(1);
+        for (auto &byte : payload) {
+            byte = (std::rand() % zero_one_in == 0) ? 0 : static_cast<uint8_t>(std::rand() % 255 + 1);
+        }
+        return payload;
+    }
+
+    void Run(const char *name, unsigned zero_one_in)
+    {
+        auto payload = MakePayload(kPacketLength, zero_one_in);
+
+        std::vector<uint8_t> frame(stpp::GetCobsMaxEncodedLength(kPacketLength) + 1);
+        auto encoded_length = stpp::CobsEncode(payload.data(), payload.size(), frame.data());
+        frame[encoded_length] = 0;
+
+        const auto rounds = kTotalBytes / kPacketLength;
+
+        // Encode
+        std::size_t sink = 0;
+        auto start       = GetSeconds();
+        for (std::size_t i = 0; i < rounds; i++) {
+            payload[0] = static_cast<uint8_t>(i | 1); // Keep the compiler from hoisting the call out of the loop
+            sink += stpp::CobsEncode(payload.data(), payload.size(), frame.data());
+        }
+        auto encode_seconds = GetSeconds() - start;
+        encoded_length      = stpp::CobsEncode(payload.data(), payload.size(), frame.data());
+
+        // Decode a stream of back-to-back frames, fed in 64-byte chunks like DMA half-transfer events
+        std::vector<uint8_t> stream;
+        for (int i = 0; i < 64; i++) {
+            stream.insert(stream.end(), frame.begin(), frame.begin() + encoded_length);
+            stream.push_back(0);
+        }
+
+        stpp::CobsDecoder decoder(kPacketLength);
+        std::size_t packets = 0;
+        start               = GetSeconds();
+        for (std::size_t i = 0; i < rounds / 64; i++) {
+            for (std::size_t offset = 0; offset < stream.size(); offset += 64) {
+                auto n = stream.size() - offset < 64 ? stream.size() - offset : 64;
+                decoder.Feed(stream.data() + offset, n, [&](const uint8_t *, std::size_t length) {
+                    packets++;
+                    sink += length;
+                });
+            }
+        }
+        auto decode_seconds = GetSeconds() - start;
+
+        std::printf("%-24s encode %8.1f MB/s   decode %8.1f MB/s   (%zu packets, sink %zu)\n",
+                    name,
+                    kTotalBytes / encode_seconds / 1e6,
+                    kTotalBytes / decode_seconds / 1e6,
+                    packets,
+                    sink);
+    }
+}
+
+int main()
+{
+    Run("no zeros", 1u << 30);
+    Run("one zero in 64 bytes", 64);
+    Run("one zero in 8 bytes", 8);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Host benchmark of the software CRC kernels (byte-wise table, slicing-by-4, slicing-by-8).
+// Not part of the firmware (bench/ is not an EIDE source folder). The STM32H7 CRC unit backend can only be timed
+// on the target, see the CRC section of src/stpp/docs/device_framework_docs.md.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Isrc bench/crc_bench.cpp -o /tmp/crc_bench && /tmp/crc_bench
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <stpp/crc.hpp>
+
+namespace
+{
+    constexpr std::size_t kTotalBytes  = 256 * 1024 * 1024; // Bytes checksummed per measurement
+    constexpr std::size_t kBlockLength = 1024;              // Roughly a large framed packet
+
+    double GetSeconds()
+    {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    template <typename Crc_t>
+    double Measure(std::vector<uint8_t> &block, uint32_t &sink)
+    {
+        auto start = GetSeconds();
+        for (std::size_t i = 0; i < kTotalBytes / kBlockLength; i++) {
+            block[0] = static_cast<uint8_t>(i); // Keep the compiler from hoisting the call out of the loop
+            sink += Crc_t::Compute(block.data(), block.size());
+        }
+        return kTotalBytes / (GetSeconds() - start) / 1e6;
+    }
+
+    template <typename Spec_t>
+    void Run(const char *name, std::vector<uint8_t> &block, uint32_t &sink)
+    {
+        using namespace stpp::crc;
+
+        auto bytewise = Measure<SoftwareCrc<Spec_t, 1>>(block, sink);
+        auto slice4   = Measure<SoftwareCrc<Spec_t, 4>>(block, sink);
+        auto slice8   = Measure<SoftwareCrc<Spec_t, 8>>(block, sink);
+        std::printf("%-8s byte-wise %8.1f MB/s   slicing-by-4 %8.1f MB/s   slicing-by-8 %8.1f MB/s\n", name, bytewise, slice4, slice8);
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> block(kBlockLength);
+    for (std::size_t i = 0; i < block.size(); i++) {
+        block[i] = static_cast<uint8_t>(i * 131 + 7);
+    }
+
+    uint32_t sink = 0;
+    Run<stpp::crc::Crc8Spec>("CRC-8", block, sink);
+    Run<stpp::crc::Crc16Spec>("CRC-16", block, sink);
+    Run<stpp::crc::Crc32Spec>("CRC-32", block, sink);
+    std::printf("(sink %u)\n", static_cast<unsigned>(sink));
+    return 0;
+}
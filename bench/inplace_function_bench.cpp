@@ -0,0 +1,112 @@
+// Host benchmark of callback dispatch: stpp::InplaceFunction against std::function. Measures the cost of storing a
+// completion callback (as every Async* call and every transfer does) and of calling it, and counts heap allocations
+// with a replaced global operator new. InplaceFunction must not allocate at all. Not part of the firmware
+// (bench/ is not an EIDE source folder).
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Isrc bench/inplace_function_bench.cpp -o /tmp/inplace_function_bench && /tmp/inplace_function_bench
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <stpp/inplace_function.hpp>
+
+namespace
+{
+    constexpr std::size_t kIterations = 20000000;
+
+    std::size_t g_allocation_count = 0;
+
+    double GetSeconds()
+    {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    enum class ErrorCode { OK, ERROR };
+
+    struct Context {
+        uint32_t completed = 0;
+        uint32_t failed    = 0;
+    };
+
+    struct Result {
+        double store_ns;
+        double call_ns;
+        std::size_t allocations;
+    };
+
+    // Stores a callback capturing three pointers (more than the small buffer of std::function in libstdc++),
+    // then calls it, like a request being queued and completed
+    template <typename Func_t>
+    Result Run(Context &context)
+    {
+        Func_t callback;
+        uint32_t id            = 0;
+        uint32_t *completed    = &context.completed;
+        uint32_t *failed       = &context.failed;
+        auto allocations_start = g_allocation_count;
+
+        auto start = GetSeconds();
+        for (std::size_t i = 0; i < kIterations; i++) {
+            id++;
+            callback = [completed, failed, &id](ErrorCode ec) {
+                (ec == ErrorCode::OK ? *completed : *failed) += 1 + (id & 1);
+            };
+        }
+        auto store_seconds = GetSeconds() - start;
+        auto allocations   = g_allocation_count - allocations_start;
+
+        start = GetSeconds();
+        for (std::size_t i = 0; i < kIterations; i++) {
+            callback((i & 7) == 0 ? ErrorCode::ERROR : ErrorCode::OK);
+        }
+        auto call_seconds = GetSeconds() - start;
+
+        return {store_seconds / kIterations * 1e9, call_seconds / kIterations * 1e9, allocations};
+    }
+
+    void Print(const char *name, const Result &result)
+    {
+        std::printf("%-16s store %6.2f ns   call %6.2f ns   allocations %zu\n", name, result.store_ns, result.call_ns, result.allocations);
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    g_allocation_count++;
+    if (auto p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    Context context;
+
+    auto std_result     = Run<std::function<void(ErrorCode)>>(context);
+    auto inplace_result = Run<stpp::InplaceFunction<void(ErrorCode)>>(context);
+    Print("std::function", std_result);
+    Print("InplaceFunction", inplace_result);
+    std::printf("(completed %u, failed %u)\n", context.completed, context.failed);
+
+    if (inplace_result.allocations != 0) {
+        std::printf("FAILED: InplaceFunction allocated %zu times\n", inplace_result.allocations);
+        return 1;
+    }
+    return 0;
+}
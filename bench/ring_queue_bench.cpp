@@ -0,0 +1,134 @@
+// Host benchmark of the ByteDevice request queue: the std::queue over std::list used before (one heap node per request)
+// against stpp::RingQueue (storage allocated once). Each message is a request descriptor the size of a queued write,
+// pushed and later popped in bursts like a producer filling the queue and the daemon draining it. Reports msgs/s and
+// heap allocations. Not part of the firmware (bench/ is not an EIDE source folder). On the target the old queue
+// allocated from a mem_-limited allocator inside a critical section, so the gap there is larger than on the host.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Isrc bench/ring_queue_bench.cpp -o /tmp/ring_queue_bench && /tmp/ring_queue_bench
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <queue>
+#include <stpp/inplace_function.hpp>
+#include <stpp/ring_queue.hpp>
+
+namespace
+{
+    constexpr std::size_t kMessages  = 20000000;
+    constexpr std::size_t kBurst     = 16;   // Default queue_capacity of ByteDevice
+    constexpr std::size_t kFailingId = 0x5a; // One request completes with an error
+
+    std::size_t g_allocation_count = 0;
+
+    double GetSeconds()
+    {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    // Same members as a queued write: data, length, request id and completion callback
+    struct Request {
+        const uint8_t *data = nullptr;
+        std::size_t length  = 0;
+        uint32_t id         = 0;
+        stpp::InplaceFunction<void(int)> callback;
+    };
+
+    struct ListQueue {
+        std::queue<Request, std::list<Request>> queue;
+
+        bool Push(Request &&request)
+        {
+            queue.push(std::move(request));
+            return true;
+        }
+
+        bool Pop(Request &request)
+        {
+            if (queue.empty()) {
+                return false;
+            }
+            request = std::move(queue.front());
+            queue.pop();
+            return true;
+        }
+    };
+
+    struct RingQueueAdapter {
+        stpp::RingQueue<Request> queue{kBurst};
+
+        bool Push(Request &&request)
+        {
+            return queue.PushBack(std::move(request));
+        }
+
+        bool Pop(Request &request)
+        {
+            return queue.PopFront(request);
+        }
+    };
+
+    template <typename Queue_t>
+    void Run(const char *name)
+    {
+        Queue_t queue;
+        uint32_t completed     = 0;
+        uint8_t payload[16]    = {};
+        auto allocations_start = g_allocation_count;
+
+        auto start = GetSeconds();
+        for (std::size_t i = 0; i < kMessages; i += kBurst) {
+            for (std::size_t j = 0; j < kBurst; j++) {
+                Request request;
+                request.data     = payload;
+                request.length   = sizeof(payload);
+                request.id       = static_cast<uint32_t>(i + j);
+                request.callback = [&completed](int ec) { completed += ec == 0; };
+                if (!queue.Push(std::move(request))) {
+                    std::printf("FAILED: queue full\n");
+                    std::exit(1);
+                }
+            }
+
+            Request request;
+            while (queue.Pop(request)) {
+                request.callback(request.id == kFailingId);
+            }
+        }
+        auto seconds = GetSeconds() - start;
+
+        std::printf("%-22s %8.1f M msgs/s   allocations per msg %.2f   (completed %u)\n", name, kMessages / seconds / 1e6,
+                    static_cast<double>(g_allocation_count - allocations_start) / kMessages, completed);
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    g_allocation_count++;
+    if (auto p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    Run<ListQueue>("before: std::list");
+    Run<RingQueueAdapter>("after: stpp::RingQueue");
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Host loopback benchmark of the RPC engine. Two stpp::rpc::Endpoint objects talk over an in-memory byte stream
+// with the same framing as the firmware (in-place COBS encoding, 0x00 delimiters, CRC-16), so the numbers cover
+// argument serialization, framing, CRC, decoding, dispatch and reply. Not part of the firmware
+// (bench/ is not an EIDE source folder).
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Isrc bench/rpc_bench.cpp -o /tmp/rpc_bench && /tmp/rpc_bench
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <stpp/cobs.hpp>
+#include <stpp/rpc.hpp>
+
+namespace
+{
+    constexpr std::size_t kMaxPacketLength = 512;
+    constexpr std::size_t kTotalCalls      = 1000000;
+    constexpr uint8_t kEcho                = 0;
+
+    double GetSeconds()
+    {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    // Mirrors CobsFramer: the packet is written after the worst-case COBS overhead and encoded to the front in place
+    struct StreamTransport {
+        struct Packet {
+            std::vector<uint8_t> storage;
+            uint8_t *data = nullptr;
+        };
+
+        std::vector<uint8_t> *stream;
+
+        Packet AllocatePacket(std::size_t max_length)
+        {
+            Packet packet;
+            auto overhead = stpp::GetCobsMaxEncodedLength(max_length) - max_length;
+            packet.storage.resize(overhead + max_length + 1);
+            packet.data = packet.storage.data() + overhead;
+            return packet;
+        }
+
+        bool SendPacket(Packet &&packet, std::size_t length)
+        {
+            auto encoded_length = stpp::CobsEncode(packet.data, length, packet.storage.data());
+            stream->insert(stream->end(), packet.storage.data(), packet.storage.data() + encoded_length);
+            stream->push_back(0);
+            return true;
+        }
+    };
+
+    using BenchEndpoint = stpp::rpc::Endpoint<StreamTransport>;
+
+    struct Side {
+        std::vector<uint8_t> rx_stream;
+        stpp::CobsDecoder decoder{kMaxPacketLength};
+
+        void Drain(BenchEndpoint &endpoint)
+        {
+            decoder.Feed(rx_stream.data(), rx_stream.size(), [&](const uint8_t *packet, std::size_t length) {
+                endpoint.OnPacket(packet, length);
+            });
+            rx_stream.clear();
+        }
+    };
+
+    void Run(std::size_t payload_length, std::size_t pipeline_depth)
+    {
+        Side client_side, server_side;
+        BenchEndpoint client(StreamTransport{&server_side.rx_stream}, kMaxPacketLength, 1, pipeline_depth);
+        BenchEndpoint server(StreamTransport{&client_side.rx_stream}, kMaxPacketLength, 1, pipeline_depth);
+
+        server.Register(kEcho, [](stpp::rpc::Reader &args, stpp::rpc::Writer &reply) {
+            auto length = args.GetRemaining();
+            reply.WriteBytes(args.ReadBytes(length), length);
+        });
+
+        std::vector<uint8_t> payload(payload_length);
+        for (std::size_t i = 0; i < payload.size(); i++) {
+            payload[i] = static_cast<uint8_t>(i * 37 + 1);
+        }
+
+        std::size_t completed = 0, failed = 0;
+        auto on_result = [&](stpp::rpc::Status status, stpp::rpc::Reader &result) {
+            if (status != stpp::rpc::Status::kOk || result.GetLength() != payload_length) {
+                failed++;
+            }
+            completed++;
+        };
+
+        auto start = GetSeconds();
+        while (completed < kTotalCalls) {
+            while (client.AsyncCall(kEcho, payload.data(), payload.size(), on_result)) {
+            }
+            server_side.Drain(server);
+            client_side.Drain(client);
+        }
+        auto seconds = GetSeconds() - start;
+
+        std::printf("payload %4zu B  depth %2zu  %10.0f calls/s  %8.1f MB/s each way%s\n", payload_length, pipeline_depth,
+                    completed / seconds, completed * payload_length / seconds / 1e6, failed == 0 ? "" : "  (FAILED CALLS)");
+    }
+}
+
+int main()
+{
+    for (std::size_t payload_length : {8, 64, 256}) {
+        for (std::size_t pipeline_depth : {1, 16}) {
+            Run(payload_length, pipeline_depth);
+        }
+    }
+    return 0;
+}
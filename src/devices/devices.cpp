@@ -1,6 +1,8 @@
 #include "devices.hpp"
 #include <stpp/device_framework/drivers/uart_driver.hpp>
 #include <usart.h>
+#include <HighPrecisionTime/high_precision_time.h>
+#include <stpp/device_framework/io_trace.hpp>
 
 namespace devices
 {
@@ -9,11 +11,24 @@ namespace devices
 
     // Device defines end
 
+    stpp::device::IoScheduler Scheduler;
+
     void InitDevices()
     {
         using namespace stpp::driver;
         using namespace stpp::device;
+
+#ifdef STPP_IO_TRACE
+        auto systick_hz = HPT_GetSysTickClkSource() == SYSTICK_CLKSOURCE_HCLK ? SystemCoreClock : SystemCoreClock / 8;
+        io_trace::SetClock(HPT_GetTotalSysTick, systick_hz); // 在创建设备之前设置，入队事件才有时间戳
+#endif
+
         Uart1 = std::make_unique<ByteDevice>(std::make_unique<UartDriver>(&huart1), 1024);
-        Uart1->Open();
+        Uart1->EnableTxCoalescing(256);
+        Uart1->SetStatsClock(HPT_GetTotalSysTick);
+        Scheduler.Register(*Uart1);
+        Uart1->StartStreaming(1024);
+
+        Scheduler.Start();
     }
-}
\ No newline at end of file
+}
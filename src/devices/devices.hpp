@@ -1,10 +1,12 @@
 #pragma once
 
 #include <stpp/device_framework/byte_device.hpp>
+#include <stpp/device_framework/io_scheduler.hpp>
 #include <memory>
 
 namespace devices
 {
     void InitDevices();
     extern std::unique_ptr<stpp::device::ByteDevice> Uart1;
+    extern stpp::device::IoScheduler Scheduler; // 所有设备共用的 I/O 调度线程
 }
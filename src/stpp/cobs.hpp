@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "find_byte.hpp"
+
+namespace stpp
+{
+    /**
+     * @brief Worst-case size of CobsEncode() output for length input bytes, not counting the delimiter
+     *
+     */
+    constexpr std::size_t GetCobsMaxEncodedLength(std::size_t length)
+    {
+        return length + length / 254 + 1;
+    }
+
+    /**
+     * @brief Encode a packet with Consistent Overhead Byte Stuffing, so that the output contains no 0x00 byte.
+     * @note The 0x00 frame delimiter is not appended. Runs of non-zero bytes are located with FindByte()
+     *       and copied with memcpy, so the cost per input byte is far below a byte-wise loop.
+     *
+     * @param dst Must hold GetCobsMaxEncodedLength(length) bytes. May overlap src only when src lies at least
+     *            GetCobsMaxEncodedLength(length) - length bytes after dst, which allows encoding in place
+     * @return std::size_t Number of bytes written to dst
+     */
+    inline std::size_t CobsEncode(const void *src, std::size_t length, void *dst)
+    {
+        auto in  = static_cast<const uint8_t *>(src);
+        auto out = static_cast<uint8_t *>(dst);
+
+        std::size_t pos = 0;
+        while (true) {
+            auto remaining = length - pos;
+            auto run_max   = remaining < 254 ? remaining : 254;
+            auto run       = FindByte(in + pos, run_max, 0);
+
+            *out++ = static_cast<uint8_t>(run + 1); // Code byte: the run length, 0xff for a full run without a zero after it
+            if (run != 0) {
+                std::memmove(out, in + pos, run); // The output never overtakes the unread input, see dst
+            }
+            out += run;
+            pos += run;
+
+            if (run < run_max) {
+                pos++; // The zero is implied by the code byte
+                continue;
+            }
+            if (pos == length) {
+                break;
+            }
+        }
+        return out - static_cast<uint8_t *>(dst);
+    }
+
+    /**
+     * @brief Incremental COBS decoder. Feed it bytes as they arrive; each 0x00 delimiter completes a packet.
+     * @note Packets longer than the capacity and malformed frames are dropped and counted in GetErrorCount().
+     *       Empty frames (consecutive delimiters) are skipped silently.
+     */
+    class CobsDecoder
+    {
+    public:
+        /**
+         * @param capacity Max decoded packet length in bytes
+         */
+        CobsDecoder(std::size_t capacity)
+            : capacity_(capacity)
+        {
+            buffer_ = new uint8_t[capacity];
+        }
+
+        CobsDecoder(const CobsDecoder &)            = delete;
+        CobsDecoder &operator=(const CobsDecoder &) = delete;
+
+        ~CobsDecoder()
+        {
+            delete[] buffer_;
+        }
+
+        /**
+         * @brief Decode data. on_packet(const uint8_t *packet, std::size_t length) is called for every complete packet
+         * @note The packet pointer is only valid during the call
+         */
+        template <typename F>
+        void Feed(const void *data, std::size_t length, F &&on_packet)
+        {
+            auto in = static_cast<const uint8_t *>(data);
+
+            std::size_t i = 0;
+            while (i < length) {
+                if (block_remaining_ == 0) {
+                    auto code = in[i++];
+                    if (code == 0) {
+                        EndFrame(on_packet);
+                        continue;
+                    }
+
+                    if (is_zero_pending_) {
+                        const uint8_t zero = 0;
+                        Append(&zero, 1);
+                    }
+                    is_in_frame_     = true;
+                    is_zero_pending_ = code != 0xff;
+                    block_remaining_ = code - 1;
+                    continue;
+                }
+
+                // Copy as much of the current block as is available. A zero inside a block is a delimiter
+                // arriving too early: the frame was cut short, drop it and start over after the delimiter
+                auto n   = block_remaining_ < length - i ? block_remaining_ : length - i;
+                auto run = FindByte(in + i, n, 0);
+                Append(in + i, run);
+                i += run;
+                block_remaining_ -= run;
+
+                if (run < n) {
+                    i++;
+                    error_count_++;
+                    Reset();
+                }
+            }
+        }
+
+        /**
+         * @brief Drop the partially received packet, e.g. after the link was interrupted
+         *
+         */
+        void Reset()
+        {
+            length_          = 0;
+            block_remaining_ = 0;
+            is_zero_pending_ = false;
+            is_in_frame_     = false;
+            is_overflow_     = false;
+        }
+
+        std::size_t GetCapacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+         * @brief Number of dropped packets, either too long or malformed
+         *
+         */
+        uint32_t GetErrorCount() const
+        {
+            return error_count_;
+        }
+
+    private:
+        uint8_t *buffer_;
+        std::size_t capacity_;
+        std::size_t length_          = 0;
+        std::size_t block_remaining_ = 0;     // Data bytes left in the current block
+        bool is_zero_pending_        = false; // The current block ends with an implied zero, emitted only if another block follows
+        bool is_in_frame_            = false;
+        bool is_overflow_            = false;
+        uint32_t error_count_        = 0;
+
+        void Append(const uint8_t *data, std::size_t length)
+        {
+            if (is_overflow_ || length > capacity_ - length_) {
+                is_overflow_ = true;
+                return;
+            }
+            std::memcpy(buffer_ + length_, data, length);
+            length_ += length;
+        }
+
+        template <typename F>
+        void EndFrame(F &on_packet)
+        {
+            if (is_overflow_) {
+                error_count_++;
+            } else if (is_in_frame_) {
+                on_packet(static_cast<const uint8_t *>(buffer_), length_);
+            }
+            Reset();
+        }
+    };
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace stpp
+{
+    namespace crc
+    {
+        /**
+         * @brief Parameters of a CRC in the usual Rocksoft model (input and output reflection are the same).
+         *
+         * @tparam Width Register width in bits, 8 to 32
+         * @tparam Poly Generator polynomial without the top bit, not reflected
+         * @tparam Init Initial register value, not reflected
+         * @tparam Reflected Bytes are processed LSB first and the result is reflected
+         * @tparam XorOut Value xored into the final result
+         */
+        template <unsigned Width, uint32_t Poly, uint32_t Init, bool Reflected, uint32_t XorOut>
+        struct Spec {
+            static_assert(Width >= 8 && Width <= 32, "Only CRCs 8 to 32 bits wide are supported");
+
+            using Value_t = std::conditional_t<Width <= 8, uint8_t, std::conditional_t<Width <= 16, uint16_t, uint32_t>>;
+
+            static constexpr unsigned kWidth     = Width;
+            static constexpr uint32_t kPoly      = Poly;
+            static constexpr uint32_t kInit      = Init;
+            static constexpr bool kIsReflected   = Reflected;
+            static constexpr uint32_t kXorOut    = XorOut;
+            static constexpr uint32_t kValueMask = Width == 32 ? 0xffffffffu : (1u << Width) - 1;
+        };
+
+        using Crc8Spec        = Spec<8, 0x07, 0x00, false, 0x00>;                       // CRC-8/SMBUS, check 0xf4
+        using Crc16Spec       = Spec<16, 0x1021, 0xffff, false, 0x0000>;                // CRC-16/IBM-3740 (CCITT-FALSE), check 0x29b1
+        using Crc16ModbusSpec = Spec<16, 0x8005, 0xffff, true, 0x0000>;                 // CRC-16/MODBUS, check 0x4b37
+        using Crc32Spec       = Spec<32, 0x04c11db7, 0xffffffff, true, 0xffffffff>;     // CRC-32/ISO-HDLC (zlib, Ethernet), check 0xcbf43926
+        using Crc32Mpeg2Spec  = Spec<32, 0x04c11db7, 0xffffffff, false, 0x00000000>;    // CRC-32/MPEG-2, the reset configuration of the STM32 CRC unit, check 0x0376e6e7
+
+        namespace crc_internal
+        {
+            constexpr uint32_t Reflect(uint32_t value, unsigned width)
+            {
+                uint32_t result = 0;
+                for (unsigned i = 0; i < width; i++) {
+                    result = (result << 1) | ((value >> i) & 1);
+                }
+                return result;
+            }
+
+            /**
+             * @brief Lookup tables of the slicing-by-N kernel. table[k][b] is the register after byte b followed by k zero bytes.
+             * @note Reflected CRCs keep the register in the low Width bits. Non-reflected CRCs keep it left-aligned in
+             *       32 bits so that one kernel serves every width.
+             */
+            template <typename Spec_t, std::size_t Slices>
+            struct Tables {
+                uint32_t table[Slices][256];
+            };
+
+            template <typename Spec_t, std::size_t Slices>
+            constexpr Tables<Spec_t, Slices> MakeTables()
+            {
+                Tables<Spec_t, Slices> tables{};
+
+                for (uint32_t b = 0; b < 256; b++) {
+                    uint32_t r = 0;
+                    if constexpr (Spec_t::kIsReflected) {
+                        constexpr auto poly = Reflect(Spec_t::kPoly, Spec_t::kWidth);
+
+                        r = b;
+                        for (int i = 0; i < 8; i++) {
+                            r = (r & 1) ? (r >> 1) ^ poly : r >> 1;
+                        }
+                    } else {
+                        constexpr auto poly = Spec_t::kPoly << (32 - Spec_t::kWidth);
+
+                        r = b << 24;
+                        for (int i = 0; i < 8; i++) {
+                            r = (r & 0x80000000u) ? (r << 1) ^ poly : r << 1;
+                        }
+                    }
+                    tables.table[0][b] = r;
+                }
+
+                for (std::size_t k = 1; k < Slices; k++) {
+                    for (uint32_t b = 0; b < 256; b++) {
+                        auto prev = tables.table[k - 1][b];
+                        if constexpr (Spec_t::kIsReflected) {
+                            tables.table[k][b] = (prev >> 8) ^ tables.table[0][prev & 0xff];
+                        } else {
+                            tables.table[k][b] = (prev << 8) ^ tables.table[0][prev >> 24];
+                        }
+                    }
+                }
+                return tables;
+            }
+
+            // Computed at compile time, so the tables live in flash
+            template <typename Spec_t, std::size_t Slices>
+            inline constexpr Tables<Spec_t, Slices> kTables = MakeTables<Spec_t, Slices>();
+
+            inline uint32_t LoadLe32(const uint8_t *p)
+            {
+                return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+            }
+
+            inline uint32_t LoadBe32(const uint8_t *p)
+            {
+                return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+            }
+        }
+
+        /**
+         * @brief Table-driven software CRC. Consumes Slices bytes per step with Slices lookup tables (slicing-by-N).
+         * @note All CRC backends share this interface: Reset(), Update(), GetValue() and the static Compute().
+         *       Update() may be called any number of times to checksum data that arrives in pieces.
+         * @note Tables take Slices KiB of flash per Spec. Slices = 1 is the classic byte-wise table loop.
+         *
+         * @tparam Slices 1, 4 or 8
+         */
+        template <typename Spec_t, std::size_t Slices = 8>
+        class SoftwareCrc
+        {
+            static_assert(Slices == 1 || Slices == 4 || Slices == 8, "Slices must be 1, 4 or 8");
+
+        public:
+            using Value_t = typename Spec_t::Value_t;
+
+            /**
+             * @brief Start a new computation
+             *
+             */
+            void Reset()
+            {
+                state_ = kInitialState;
+            }
+
+            /**
+             * @brief Feed more data
+             *
+             */
+            void Update(const void *data, std::size_t length)
+            {
+                const auto &t = crc_internal::kTables<Spec_t, Slices>.table;
+                auto p        = static_cast<const uint8_t *>(data);
+                auto state    = state_;
+
+                if constexpr (Spec_t::kIsReflected) {
+                    if constexpr (Slices == 8) {
+                        for (; length >= 8; length -= 8, p += 8) {
+                            auto lo = crc_internal::LoadLe32(p) ^ state;
+                            auto hi = crc_internal::LoadLe32(p + 4);
+                            state   = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+                                    t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+                        }
+                    } else if constexpr (Slices == 4) {
+                        for (; length >= 4; length -= 4, p += 4) {
+                            auto x = crc_internal::LoadLe32(p) ^ state;
+                            state  = t[3][x & 0xff] ^ t[2][(x >> 8) & 0xff] ^ t[1][(x >> 16) & 0xff] ^ t[0][x >> 24];
+                        }
+                    }
+
+                    for (; length > 0; length--, p++) {
+                        state = (state >> 8) ^ t[0][(state ^ *p) & 0xff];
+                    }
+                } else {
+                    if constexpr (Slices == 8) {
+                        for (; length >= 8; length -= 8, p += 8) {
+                            auto hi = crc_internal::LoadBe32(p) ^ state;
+                            auto lo = crc_internal::LoadBe32(p + 4);
+                            state   = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xff] ^ t[5][(hi >> 8) & 0xff] ^ t[4][hi & 0xff] ^
+                                    t[3][lo >> 24] ^ t[2][(lo >> 16) & 0xff] ^ t[1][(lo >> 8) & 0xff] ^ t[0][lo & 0xff];
+                        }
+                    } else if constexpr (Slices == 4) {
+                        for (; length >= 4; length -= 4, p += 4) {
+                            auto x = crc_internal::LoadBe32(p) ^ state;
+                            state  = t[3][x >> 24] ^ t[2][(x >> 16) & 0xff] ^ t[1][(x >> 8) & 0xff] ^ t[0][x & 0xff];
+                        }
+                    }
+
+                    for (; length > 0; length--, p++) {
+                        state = (state << 8) ^ t[0][(state >> 24) ^ *p];
+                    }
+                }
+
+                state_ = state;
+            }
+
+            /**
+             * @brief The CRC of all data fed since the last Reset(). Does not end the computation
+             *
+             */
+            Value_t GetValue() const
+            {
+                if constexpr (Spec_t::kIsReflected) {
+                    return static_cast<Value_t>(state_ ^ Spec_t::kXorOut);
+                } else {
+                    return static_cast<Value_t>((state_ >> (32 - Spec_t::kWidth)) ^ Spec_t::kXorOut);
+                }
+            }
+
+            static Value_t Compute(const void *data, std::size_t length)
+            {
+                SoftwareCrc crc;
+                crc.Update(data, length);
+                return crc.GetValue();
+            }
+
+        private:
+            static constexpr uint32_t kInitialState = Spec_t::kIsReflected ? crc_internal::Reflect(Spec_t::kInit, Spec_t::kWidth)
+                                                                           : Spec_t::kInit << (32 - Spec_t::kWidth);
+
+            uint32_t state_ = kInitialState;
+        };
+
+        using Crc8  = SoftwareCrc<Crc8Spec>;
+        using Crc16 = SoftwareCrc<Crc16Spec>;
+        using Crc32 = SoftwareCrc<Crc32Spec>;
+    }
+}
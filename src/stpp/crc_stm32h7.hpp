@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stm32h7xx.h>
+#include <stm32h7xx_hal.h>
+#include "crc.hpp"
+#include "freertos_lock.hpp"
+
+namespace stpp
+{
+    namespace crc
+    {
+        namespace crc_internal
+        {
+            /**
+             * @brief The CRC unit is shared by every Stm32H7Crc object. Whoever holds this mutex owns its configuration
+             *
+             */
+            inline stpp::Mutex &GetCrcUnitMutex()
+            {
+                static stpp::Mutex mutex;
+                return mutex;
+            }
+        }
+
+        /**
+         * @brief CRC computed by the STM32H7 CRC unit, with the same interface as SoftwareCrc.
+         * @note The unit is configured from Spec_t on every Update(), so objects with different specs can be used
+         *       alternately, even from different threads. Each object only stores the running value.
+         * @note Reflected CRCs are fed a word at a time (the unit reverses the bits of each word, which processes the bytes
+         *       in memory order). Non-reflected CRCs are fed byte-swapped words. Not usable from an ISR.
+         *
+         */
+        template <typename Spec_t>
+        class Stm32H7Crc
+        {
+            static_assert(Spec_t::kWidth == 8 || Spec_t::kWidth == 16 || Spec_t::kWidth == 32, "The CRC unit supports 7, 8, 16 and 32 bit polynomials");
+
+        public:
+            using Value_t = typename Spec_t::Value_t;
+
+            Stm32H7Crc()
+            {
+                __HAL_RCC_CRC_CLK_ENABLE();
+            }
+
+            void Reset()
+            {
+                state_ = Spec_t::kInit;
+            }
+
+            void Update(const void *data, std::size_t length)
+            {
+                auto p = static_cast<const uint8_t *>(data);
+
+                std::lock_guard lock(crc_internal::GetCrcUnitMutex());
+                Load();
+
+                for (; length >= 4; length -= 4, p += 4) {
+                    uint32_t word;
+                    std::memcpy(&word, p, sizeof(word));
+                    CRC->DR = Spec_t::kIsReflected ? word : __REV(word);
+                }
+
+                // Byte writes for the tail. Reflected CRCs switch to reversal by byte for them
+                if constexpr (Spec_t::kIsReflected) {
+                    CRC->CR = GetControl(CRC_CR_REV_IN_0);
+                }
+                for (; length > 0; length--, p++) {
+                    *reinterpret_cast<volatile uint8_t *>(&CRC->DR) = *p;
+                }
+
+                state_ = CRC->DR;
+            }
+
+            Value_t GetValue() const
+            {
+                // The unit always shifts MSB first. For a reflected CRC it works on bit-reversed input,
+                // so its register is the reflected CRC's register mirrored
+                auto value = Spec_t::kIsReflected ? __RBIT(state_) >> (32 - Spec_t::kWidth) : state_;
+                return static_cast<Value_t>((value ^ Spec_t::kXorOut) & Spec_t::kValueMask);
+            }
+
+            static Value_t Compute(const void *data, std::size_t length)
+            {
+                Stm32H7Crc crc;
+                crc.Update(data, length);
+                return crc.GetValue();
+            }
+
+            /**
+             * @brief Lock the CRC unit and load this CRC into it, so that a DMA stream can write the data to GetDataRegister().
+             * @note Reflected CRCs take 32-bit DMA writes, non-reflected CRCs need 8-bit DMA writes.
+             *       Call EndDmaFeed() after the transfer, then Update() may continue with more data.
+             */
+            void BeginDmaFeed()
+            {
+                crc_internal::GetCrcUnitMutex().lock();
+                Load();
+                if constexpr (!Spec_t::kIsReflected) {
+                    CRC->CR = GetControl(0); // Byte writes need no reversal
+                }
+            }
+
+            /**
+             * @brief Save the result of the DMA transfer and unlock the CRC unit
+             *
+             */
+            void EndDmaFeed()
+            {
+                state_ = CRC->DR;
+                crc_internal::GetCrcUnitMutex().unlock();
+            }
+
+            static volatile void *GetDataRegister()
+            {
+                return &CRC->DR;
+            }
+
+        private:
+            uint32_t state_ = Spec_t::kInit; // Register of the unit, right-aligned
+
+            static uint32_t GetControl(uint32_t rev_in)
+            {
+                uint32_t polysize = Spec_t::kWidth == 32 ? 0 : Spec_t::kWidth == 16 ? CRC_CR_POLYSIZE_0
+                                                                                     : CRC_CR_POLYSIZE_1;
+                return polysize | rev_in;
+            }
+
+            void Load()
+            {
+                CRC->CR   = GetControl(Spec_t::kIsReflected ? CRC_CR_REV_IN : 0);
+                CRC->POL  = Spec_t::kPoly;
+                CRC->INIT = state_;
+                CRC->CR |= CRC_CR_RESET; // Loads INIT into the data register
+            }
+        };
+    }
+}
@@ -1,10 +1,11 @@
 #pragma once
 
+#include <cstdarg>
+#include <cstdio>
 #include <cstring>
 #include <FreeRTOS.h>
 #include <stdexcept>
 #include <task.h>
-#include <list>
 #include <mutex>
 #include "drivers/byte_driver.hpp"
 #include "../freertos_lock.hpp"
@@ -12,9 +13,24 @@
 #include <functional>
 #include "../error_code.hpp"
 #include "../freertos_memory.hpp"
-#include <queue>
+#include "../ring_queue.hpp"
+#include "../continuous_buffer.hpp"
+#include "io_vec.hpp"
+#include "rx_view.hpp"
+#include "io_stats.hpp"
+#include "io_trace.hpp"
+#include "tx_priority.hpp"
+#include "io_scheduler.hpp"
+#include "io_request.hpp"
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <vector>
 #include "private_include/callback_func.hpp"
 #include "private_include/data_to_process.hpp"
+#include "private_include/stream_rx_ring.hpp"
+#include "private_include/io_stats_counters.hpp"
+#include "private_include/task_wake.hpp"
 #include "../freertos_delay_ms.h"
 #include "private_include/byte_device_daemon_task.hpp"
 
@@ -22,6 +38,13 @@ namespace stpp
 {
     namespace device
     {
+#if defined(__cpp_impl_coroutine)
+        namespace coro
+        {
+            class IoAwaitable;
+        }
+#endif
+
         class ByteDevice
         {
             using Mallocator_t       = stpp::MallocLimited<std::malloc, std::free>;
@@ -30,15 +53,67 @@ namespace stpp
             using CallbackFunc_t     = device_framework_internal::CallbackFunc_t;
 
         public:
+            using IoVec      = stpp::device::IoVec;
+            using RxView     = stpp::device::RxView;
+            using TxPriority = stpp::device::TxPriority;
+            using IoRequest  = stpp::device::IoRequest;
+            using IoStats    = stpp::device::IoStats;
+
+            using RequestId_t                              = uint32_t;
+            static constexpr RequestId_t kInvalidRequestId = 0; // 无效的请求 id
+
+            using WatermarkCallbackFunc_t = stpp::InplaceFunction<void(bool is_above_high)>;
+
+            using StatsClockFunc_t = uint32_t (*)(); // 统计延迟用的时钟，返回单调递增（允许回绕）的计数值
+
+            static constexpr std::size_t kMaxWritableWaiters = 4; // WaitWritable() 中最多同时阻塞在通知上的线程数
+
+            static constexpr std::size_t kPrintfReserveLength = 128; // AsyncPrintf() 先按这个长度预留缓冲区，与缓冲池的一个级别相同
+
+            /**
+             * @brief SubmitBatch() 的一个请求，用 Read()/Write()/WriteNoCopy() 构造
+             *
+             */
+            struct BatchEntry {
+                enum class Kind : uint8_t {
+                    kRead,
+                    kWrite,       // 复制数据，同一批的所有复制写入共用一个缓冲区
+                    kWriteNoCopy, // 不复制数据，数据必须在回调函数被调用之前一直有效
+                };
+
+                Kind kind;
+                void *data;
+                std::size_t length;
+                CallbackFunc_t callback;
+                RequestId_t *request_id = nullptr; // 不为空时保存请求的 id
+                TxPriority priority     = TxPriority::kNormal;
+
+                static BatchEntry Read(void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr)
+                {
+                    return {Kind::kRead, data, length, std::move(callback), request_id};
+                }
+
+                static BatchEntry Write(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+                {
+                    return {Kind::kWrite, const_cast<void *>(data), length, std::move(callback), request_id, priority};
+                }
+
+                static BatchEntry WriteNoCopy(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+                {
+                    return {Kind::kWriteNoCopy, const_cast<void *>(data), length, std::move(callback), request_id, priority};
+                }
+            };
+
             /**
              * @brief 构造一个字节设备
              *
              * @param driver 字节驱动
-             * @param mem_limit 内部缓冲区大小，单位字节
+             * @param mem_limit 内部缓冲区大小，单位字节。只用于存放 AsyncWrite 复制的数据
+             * @param queue_capacity 读、写请求队列各自最多能容纳的请求数
              */
-            ByteDevice(std::unique_ptr<driver::ByteDriver> driver, std::size_t mem_limit = 1024)
-                : driver_(std::move(driver)), mem_(mem_limit),
-                  tx_queue_(AllocatorLimited<TxDataWithCallback, Mallocator_t>(mem_)), rx_queue_(AllocatorLimited<RxDataWithCallback, Mallocator_t>(mem_)) {};
+            ByteDevice(std::unique_ptr<driver::ByteDriver> driver, std::size_t mem_limit = 1024, std::size_t queue_capacity = 16)
+                : driver_(std::move(driver)), mem_(mem_limit), tx_pool_(mem_),
+                  tx_queue_(queue_capacity), tx_inflight_(queue_capacity), rx_queue_(queue_capacity) {};
 
             ByteDevice(ByteDevice &&)                 = delete;
             ByteDevice(const ByteDevice &)            = delete;
@@ -48,16 +123,224 @@ namespace stpp
 
             /**
              * @brief 打开设备，启动读写守护线程
+             * @note 打开之前提交的请求只入队，打开后才开始传输
              *
              * @param daemon_thread_name 线程名称
              */
             void Open(const char *const daemon_thread_name = "ByteDevice")
             {
+                dispatch_mode_ = DispatchMode::kDaemon;
+                SetDriverCallbacks();
+
                 auto result = xTaskCreate(device_framework_internal::ByteDeviceDaemon, daemon_thread_name, 512, this, 3, &spin_task_handle_);
 
                 if (result != pdPASS) {
                     throw std::runtime_error("Failed to create ByteDevice daemon task");
                 }
+                is_opened_ = true;
+            }
+
+            /**
+             * @brief 打开设备，但不创建守护线程。每次传输完成后，直接在完成中断中开始下一个请求的传输
+             * @note 省去守护线程的栈和上下文切换，传输之间几乎没有间隔，也不依赖调度器。
+             *       代价是请求的出队、合并发送的复制等工作都在中断中进行
+             *
+             */
+            void OpenWithoutDaemon()
+            {
+                dispatch_mode_ = DispatchMode::kInterrupt;
+                SetDriverCallbacks();
+                is_opened_ = true;
+
+                // 处理 Open 之前已经入队的请求
+                DispatchTx();
+                DispatchRx();
+            }
+
+            /**
+             * @brief 开启流式接收。接收 DMA 以循环模式持续写入内部的环形缓冲区，请求之间到达的数据不会丢失。
+             *        开启后 AsyncRead/SyncRead 从环形缓冲区中取数据，数据足够时立即完成。
+             * @note 在 Open()、OpenWithoutDaemon() 或注册到 IoScheduler 之后调用，之后不能关闭
+             * @note 未读数据超过缓冲区大小时，旧数据会被覆盖，见 GetRxOverflowCount()
+             *
+             * @param ring_size 环形缓冲区大小，单位字节，必须是 2 的幂。单次读取的长度必须小于这个大小
+             * @return true 成功
+             * @return false 驱动不支持流式接收或启动失败
+             */
+            bool StartStreaming(std::size_t ring_size)
+            {
+                rx_stream_ = std::make_unique<device_framework_internal::StreamRxRing>(ring_size);
+
+                driver_->SetStreamRxCb([this](std::size_t write_pos, bool is_restarted) {
+                    if (is_restarted) {
+                        rx_stream_->Restart();
+                    } else {
+                        rx_stream_->Publish(write_pos);
+                    }
+                    NotifySpinTask(kRxComplete);
+                });
+
+                if (!driver_->StartStreamRead(rx_stream_->GetBuffer(), ring_size)) {
+                    driver_->SetStreamRxCb(nullptr);
+                    rx_stream_.reset();
+                    return false;
+                }
+                return true;
+            }
+
+            bool IsStreaming() const
+            {
+                return rx_stream_ != nullptr;
+            }
+
+            /**
+             * @brief 流式接收时，因缓冲区溢出或硬件出错而丢失数据的次数
+             *
+             */
+            uint32_t GetRxOverflowCount() const
+            {
+                return rx_stream_ != nullptr ? rx_stream_->GetOverflowCount() : 0;
+            }
+
+            /**
+             * @brief 借出环形缓冲区中所有已收到数据的只读视图，不拷贝数据。只能在流式接收时使用
+             * @note 成功后必须尽快调用 ReleaseRxView() 归还。借出期间读请求暂停处理；
+             *       如果迟迟不归还，硬件仍可能因缓冲区满而覆盖视图中的数据
+             *
+             * @param view 视图
+             * @return true 成功
+             * @return false 没有在流式接收，或者其他上下文正在读取
+             */
+            bool AcquireRxView(RxView &view)
+            {
+                if (rx_stream_ == nullptr || !rx_sem_.lock(0)) {
+                    return false;
+                }
+
+                auto [first, first_length]   = rx_stream_->Peek(0);
+                auto [second, second_length] = rx_stream_->Peek(first_length);
+                view                         = RxView{first, first_length, second, second_length};
+                return true;
+            }
+
+            /**
+             * @brief 归还 AcquireRxView() 借出的视图，把前 consumed 个字节的空间还给硬件
+             *
+             * @param consumed 已处理完的字节数，不能超过视图大小。未处理的数据下次借出时仍在视图开头
+             */
+            void ReleaseRxView(std::size_t consumed)
+            {
+                rx_stream_->Consume(consumed);
+                rx_sem_.unlock();
+
+                // 处理借出期间积压的读请求。没有读请求时不通知，以免剩余数据再次触发新数据回调
+                bool has_request;
+                {
+                    std::lock_guard lock(rx_queue_.lock);
+                    has_request = !rx_queue_.queue.IsEmpty();
+                }
+                if (has_request) {
+                    NotifySpinTask(kRxComplete);
+                }
+            }
+
+            /**
+             * @brief 设置流式接收的新数据回调。每当有新数据，且排队的读请求都已完成后仍有剩余数据时调用，
+             *        可以在回调中用 AcquireRxView() 原地解析数据
+             * @note 回调在守护线程、IoScheduler 或中断上下文中执行，取决于设备的打开方式
+             *
+             */
+            void SetRxDataCb(CallbackFunc_t callback)
+            {
+                rx_data_cb_ = std::move(callback);
+            }
+
+            /**
+             * @brief 开启小数据合并发送。守护线程会把队列头部连续的复制模式写请求（AsyncWrite、AsyncWritev）
+             *        复制到一块连续的暂存区，用一次传输发出，减少每次传输的启动和中断开销。
+             *        每个请求的回调函数在这次传输完成后按顺序调用。
+             * @note 必须在 Open() 之前调用
+             *
+             * @param staging_size 暂存区大小，单位字节。超过这个大小的请求单独发送
+             */
+            void EnableTxCoalescing(std::size_t staging_size)
+            {
+                tx_staging_ = std::make_unique<stpp::ContinuousBuffer>(staging_size);
+            }
+
+            /**
+             * @brief 设置分段发送的大小。非 TxPriority::kHigh 的请求每次最多发送 chunk_size 字节，
+             *        每段发送完后如果有更高优先级的请求在排队，先发送它们，再继续发送剩余部分
+             * @note 这样高优先级的请求最多等待一段的发送时间。分段越小，传输启动的开销越大
+             *
+             * @param chunk_size 分段大小，单位字节。为 0 时不分段（默认）
+             */
+            void SetTxChunkSize(std::size_t chunk_size)
+            {
+                tx_chunk_size_ = chunk_size;
+            }
+
+            /**
+             * @brief 设置发送队列的水位。排队和正在发送的数据达到 high 字节时以 true 调用回调函数，之后降到 low 字节以下时以 false 调用
+             * @note 回调函数可能在中断上下文中调用
+             *
+             * @param high 高水位，单位字节。为 0 时不检查水位
+             * @param low 低水位，单位字节，应小于 high
+             */
+            void SetTxWatermarks(std::size_t high, std::size_t low, WatermarkCallbackFunc_t callback)
+            {
+                tx_high_watermark_ = high;
+                tx_low_watermark_  = low;
+                tx_watermark_cb_   = std::move(callback);
+            }
+
+            /**
+             * @brief 获取排队和正在发送的数据总长度，单位字节
+             *
+             */
+            std::size_t GetTxQueuedSize() const
+            {
+                return tx_queued_size_;
+            }
+
+            /**
+             * @brief 阻塞直到可以写入 length 字节：内部缓冲区有足够空间，且 priority 的发送队列未满。不能在中断上下文中调用。
+             * @note 等待时线程阻塞在任务通知上，每当有数据发送完时被唤醒检查，不会空转。
+             *       同时等待的线程超过 kMaxWritableWaiters 个时，多出的线程每个 tick 检查一次
+             *
+             * @param length 要写入的长度，单位字节
+             * @param timeout 超时时间，单位 ms
+             * @param priority 要写入的发送队列
+             * @return true 可以写入
+             * @return false 超时
+             */
+            bool WaitWritable(std::size_t length, uint32_t timeout = std::numeric_limits<uint32_t>::max(), TxPriority priority = TxPriority::kNormal)
+            {
+                if (InHandlerMode()) {
+                    throw std::runtime_error("WaitWritable() can't be called in interrupt context.");
+                }
+
+                auto start       = xTaskGetTickCount();
+                auto ticks       = FreeRtosMsToTick(timeout);
+                auto task_handle = xTaskGetCurrentTaskHandle();
+
+                while (!IsWritable(length, priority)) {
+                    auto remaining = device_framework_internal::GetRemainingTicks(start, ticks);
+                    if (remaining == 0) {
+                        return false;
+                    }
+
+                    if (AddWritableWaiter(task_handle)) {
+                        // 登记之后再检查一次，以免登记之前数据刚好发送完而错过通知
+                        if (!IsWritable(length, priority)) {
+                            device_framework_internal::WaitWake(remaining);
+                        }
+                        RemoveWritableWaiter(task_handle);
+                    } else {
+                        vTaskDelay(1);
+                    }
+                }
+                return true;
             }
 
             /**
@@ -65,9 +348,10 @@ namespace stpp
              *
              * @param data 读取到的数据会保存在这里
              * @param length 读取数据的长度，单位字节
-             * @param timeout 超时时间，单位 ms。注意：超时返回后，数据可能还在接收中（data 可能还在被写入）
+             * @param timeout 超时时间，单位 ms。超时后请求会被取消，函数等到 driver_ 不再访问 data 后才返回。
+             *        driver_ 不支持中止且没有在流式接收时，有限的 timeout 无法保证，直接返回 false
              * @return true 读取成功
-             * @return false 读取失败
+             * @return false 读取失败、超时或被取消
              */
             bool SyncRead(void *data, std::size_t length, uint32_t timeout = std::numeric_limits<uint32_t>::max())
             {
@@ -75,23 +359,46 @@ namespace stpp
                     throw std::runtime_error("SyncRead() can't be called in interrupt context. Use AsyncRead() instead.");
                 }
 
-                auto current_task_handle = xTaskGetCurrentTaskHandle();
+                if (!IsTimeoutSupported(timeout, true)) {
+                    return false;
+                }
 
-                auto is_success = AsyncRead(data, length, [current_task_handle](stpp::ErrorCode) {
-                    if (InHandlerMode()) {
-                        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                        vTaskNotifyGiveFromISR(current_task_handle, &xHigherPriorityTaskWoken);
-                        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-                    } else {
-                        xTaskNotifyGive(current_task_handle);
-                    }
-                });
+                IoRequest request;
+                if (!AsyncRead(data, length, request)) {
+                    return false;
+                }
+
+                return WaitOrCancel(request, timeout);
+            }
+
+            /**
+             * @brief 同步读取，线程会阻塞直到读到分隔符 delimiter 或读满 max_length 字节。不能在中断上下文中调用。只能在流式接收时使用
+             * @note 见 AsyncReadUntil()
+             *
+             * @param data 读取到的数据会保存在这里，至少 max_length 字节
+             * @param max_length 最多读取的字节数，必须小于环形缓冲区大小
+             * @param delimiter 分隔符
+             * @param received_length 实际读取的字节数，包括分隔符
+             * @param timeout 超时时间，单位 ms。超时后请求会被取消
+             * @return true 读取成功
+             * @return false 读取失败、超时、被取消，或者没有在流式接收
+             */
+            bool SyncReadUntil(void *data, std::size_t max_length, uint8_t delimiter, std::size_t &received_length, uint32_t timeout = std::numeric_limits<uint32_t>::max())
+            {
+                if (InHandlerMode()) {
+                    throw std::runtime_error("SyncReadUntil() can't be called in interrupt context. Use AsyncReadUntil() instead.");
+                }
+
+                if (!IsTimeoutSupported(timeout, true)) {
+                    return false;
+                }
 
-                if (is_success) {
-                    ulTaskNotifyTake(pdTRUE, FreeRtosMsToTick(timeout)); // 等待数据发送完成
+                IoRequest request;
+                if (!AsyncReadUntil(data, max_length, delimiter, &received_length, request)) {
+                    return false;
                 }
 
-                return is_success;
+                return WaitOrCancel(request, timeout);
             }
 
             /**
@@ -99,9 +406,10 @@ namespace stpp
              *
              * @param data 要发送的数据
              * @param length 数据长度，单位字节
-             * @param timeout 超时时间，单位 ms。注意：超时返回后，数据可能还在发送中
+             * @param timeout 超时时间，单位 ms。超时后请求会被取消，函数等到 driver_ 不再访问数据后才返回。
+             *        driver_ 不支持中止时，有限的 timeout 无法保证，直接返回 false
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 写入失败、超时或被取消
              */
             bool SyncWrite(const void *data, std::size_t length, uint32_t timeout = std::numeric_limits<uint32_t>::max())
             {
@@ -109,32 +417,26 @@ namespace stpp
                     throw std::runtime_error("SyncWrite() can't be called in interrupt context. Use AsyncWrite() instead.");
                 }
 
-                auto current_task_handle = xTaskGetCurrentTaskHandle();
-
-                auto is_success = AsyncWriteNoCopy(data, length, [current_task_handle](stpp::ErrorCode) {
-                    if (InHandlerMode()) {
-                        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                        vTaskNotifyGiveFromISR(current_task_handle, &xHigherPriorityTaskWoken);
-                        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-                    } else {
-                        xTaskNotifyGive(current_task_handle);
-                    }
-                });
+                if (!IsTimeoutSupported(timeout, false)) {
+                    return false;
+                }
 
-                if (is_success) {
-                    ulTaskNotifyTake(pdTRUE, FreeRtosMsToTick(timeout)); // 等待数据发送完成
+                IoRequest request;
+                if (!AsyncWriteNoCopy(data, length, request)) {
+                    return false;
                 }
 
-                return is_success;
+                return WaitOrCancel(request, timeout);
             }
 
             /**
              * @brief 同步写入，线程会阻塞直到数据发送完成。不能在中断上下文中调用。
              *
              * @param str 要发送的数据
-             * @param timeout 超时时间，单位 ms。注意：超时返回后，数据可能还在发送中
+             * @param timeout 超时时间，单位 ms。超时后请求会被取消，函数等到 driver_ 不再访问数据后才返回。
+             *        driver_ 不支持中止时，有限的 timeout 无法保证，直接返回 false
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 写入失败、超时或被取消
              */
             bool SyncWrite(const std::string_view str, uint32_t timeout = std::numeric_limits<uint32_t>::max())
             {
@@ -142,43 +444,70 @@ namespace stpp
                     throw std::runtime_error("SyncWrite() can't be called in interrupt context. Use AsyncWrite() instead.");
                 }
 
-                auto current_task_handle = xTaskGetCurrentTaskHandle();
-
-                auto is_success = AsyncWriteNoCopy(str.data(), str.length(), [current_task_handle](stpp::ErrorCode) {
-                    if (InHandlerMode()) {
-                        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                        vTaskNotifyGiveFromISR(current_task_handle, &xHigherPriorityTaskWoken);
-                        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-                    } else {
-                        xTaskNotifyGive(current_task_handle);
-                    }
-                });
+                if (!IsTimeoutSupported(timeout, false)) {
+                    return false;
+                }
 
-                if (is_success) {
-                    ulTaskNotifyTake(pdTRUE, FreeRtosMsToTick(timeout)); // 等待数据发送完成
+                IoRequest request;
+                if (!AsyncWriteNoCopy(str.data(), str.length(), request)) {
+                    return false;
                 }
 
-                return true;
+                return WaitOrCancel(request, timeout);
             }
 
             /**
              * @brief 异步读取，不会阻塞。可以在中断上下文中调用。
              *
              * @param data 读取到的数据会保存在这里
-             * @param length 数据长度，单位字节
+             * @param length 数据长度，单位字节。流式接收时必须小于环形缓冲区大小
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
              * @return true 成功
              * @return false 失败
              */
-            bool AsyncRead(void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
+            bool AsyncRead(void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr)
             {
+                if (rx_stream_ != nullptr && length > rx_stream_->GetMaxReadLength()) {
+                    return false; // 流式接收时永远不会满足
+                }
+
                 try {
                     RxDataWithCallback data_with_cb(static_cast<uint8_t *>(data), length, std::move(callback));
-                    {
-                        std::lock_guard lock(rx_queue_.lock);
-                        rx_queue_.queue.push(std::move(data_with_cb));
-                    }
-                    NotifySpinTask();
-                    return true;
+                    return PushRx(std::move(data_with_cb), request_id);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            }
+
+            /**
+             * @brief 异步读取，读到分隔符 delimiter 为止，不会阻塞。可以在中断上下文中调用。只能在流式接收时使用
+             * @note 数据到达时只查找新到的部分，分隔符一到立即完成。读出的数据包括分隔符，分隔符之后的数据留在环形缓冲区中，
+             *       由下一个读请求读出。max_length 字节内没有分隔符时读满 max_length 字节后完成，此时最后一个字节不是分隔符
+             *
+             * @param data 读取到的数据会保存在这里，至少 max_length 字节
+             * @param max_length 最多读取的字节数，必须小于环形缓冲区大小
+             * @param delimiter 分隔符，如 '\n'
+             * @param received_length 不为空时，在调用回调函数之前保存实际读取的字节数
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @return true 成功
+             * @return false 失败，或者没有在流式接收
+             */
+            bool AsyncReadUntil(void *data, std::size_t max_length, uint8_t delimiter, std::size_t *received_length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr)
+            {
+                if (rx_stream_ == nullptr || max_length == 0 || max_length > rx_stream_->GetMaxReadLength()) {
+                    return false;
+                }
+
+                if (received_length != nullptr) {
+                    *received_length = 0;
+                }
+
+                try {
+                    RxDataWithCallback data_with_cb(static_cast<uint8_t *>(data), max_length, std::move(callback));
+                    data_with_cb.is_until_        = true;
+                    data_with_cb.delimiter_       = delimiter;
+                    data_with_cb.received_length_ = received_length;
+                    return PushRx(std::move(data_with_cb), request_id);
                 } catch (const std::exception &e) {
                     return false;
                 }
@@ -189,19 +518,20 @@ namespace stpp
              *
              * @param data 要发送的数据
              * @param length 数据长度，单位字节
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 数据长度为 0，或者写入失败
              */
-            bool AsyncWrite(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
+            bool AsyncWrite(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
+                if (length == 0) {
+                    return false;
+                }
+
                 try {
-                    TxDataWithCallback data_with_cb(mem_, static_cast<const uint8_t *>(data), length, std::move(callback));
-                    {
-                        std::lock_guard lock(tx_queue_.lock);
-                        tx_queue_.queue.push(std::move(data_with_cb));
-                    }
-                    NotifySpinTask();
-                    return true;
+                    TxDataWithCallback data_with_cb(tx_pool_, static_cast<const uint8_t *>(data), length, std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
                 } catch (const std::exception &e) {
                     return false;
                 }
@@ -211,19 +541,20 @@ namespace stpp
              * @brief 异步写入，不会阻塞。可以在中断上下文中调用。
              *
              * @param str 要发送的数据
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 数据长度为 0，或者写入失败
              */
-            bool AsyncWrite(const std::string_view str, CallbackFunc_t callback = CallbackFunc_t())
+            bool AsyncWrite(const std::string_view str, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
+                if (str.empty()) {
+                    return false;
+                }
+
                 try {
-                    TxDataWithCallback data_with_cb(mem_, reinterpret_cast<const uint8_t *>(str.data()), str.length(), std::move(callback));
-                    {
-                        std::lock_guard lock(tx_queue_.lock);
-                        tx_queue_.queue.push(std::move(data_with_cb));
-                    }
-                    NotifySpinTask();
-                    return true;
+                    TxDataWithCallback data_with_cb(tx_pool_, reinterpret_cast<const uint8_t *>(str.data()), str.length(), std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
                 } catch (const std::exception &e) {
                     return false;
                 }
@@ -234,19 +565,20 @@ namespace stpp
              *
              * @param data 要发送的数据
              * @param length 数据长度，单位字节
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 数据长度为 0，或者写入失败
              */
-            bool AsyncWriteNoCopy(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
+            bool AsyncWriteNoCopy(const void *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
+                if (length == 0) {
+                    return false;
+                }
+
                 try {
                     TxDataWithCallback data_with_cb(static_cast<const uint8_t *>(data), length, std::move(callback));
-                    {
-                        std::lock_guard lock(tx_queue_.lock);
-                        tx_queue_.queue.push(std::move(data_with_cb));
-                    }
-                    NotifySpinTask();
-                    return true;
+                    return PushTx(std::move(data_with_cb), request_id, priority);
                 } catch (const std::exception &e) {
                     return false;
                 }
@@ -256,162 +588,1529 @@ namespace stpp
              * @brief 异步写入，不会阻塞。可以在中断上下文中调用。这个函数不会将 data 复制到内部缓冲区，而是直接使用 data。data 必须保证在回调函数被调用之前一直有效。
              *
              * @param str 要发送的数据
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
              * @return true 写入成功
-             * @return false 写入失败
+             * @return false 数据长度为 0，或者写入失败
              */
-            bool AsyncWriteNoCopy(const std::string_view str, CallbackFunc_t callback = CallbackFunc_t())
+            bool AsyncWriteNoCopy(const std::string_view str, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
+                if (str.empty()) {
+                    return false;
+                }
+
                 try {
                     TxDataWithCallback data_with_cb(reinterpret_cast<const uint8_t *>(str.data()), str.length(), std::move(callback));
-                    {
-                        std::lock_guard lock(tx_queue_.lock);
-                        tx_queue_.queue.push(std::move(data_with_cb));
-                    }
-                    NotifySpinTask();
-                    return true;
+                    return PushTx(std::move(data_with_cb), request_id, priority);
                 } catch (const std::exception &e) {
                     return false;
                 }
             }
 
-            driver::ByteDriver *GetDriver() const
+            /**
+             * @brief 异步写入，不会阻塞。可以在中断上下文中调用。这个函数接管 data 的所有权，不复制数据，请求结束后（包括取消）释放 data。
+             * @note 写入失败时 data 可能已被释放，调用后不要再使用 data
+             * @note 设备使用中断分发模式时 data 可能在中断中释放，此时 data 的内存必须能在中断中释放
+             *
+             * @param data 要发送的数据
+             * @param length 数据长度，单位字节
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 数据长度为 0，或者写入失败
+             */
+            bool AsyncWrite(std::unique_ptr<uint8_t[]> &&data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
-                return driver_.get();
+                auto ptr = data.get();
+                return PushOwnedTx(std::move(data), ptr, length, std::move(callback), request_id, priority);
             }
 
             /**
-             * @brief 获取已分配的内存大小
+             * @brief 异步写入，不会阻塞。可以在中断上下文中调用。这个函数接管 data 的所有权，不复制数据，请求结束后（包括取消）释放 data。
+             * @note 写入失败时 data 可能已被释放，调用后不要再使用 data
+             * @note 设备使用中断分发模式时 data 可能在中断中释放，此时 data 的内存必须能在中断中释放
              *
-             * @return std::size_t
+             * @param data 要发送的数据，发送全部元素
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 数据长度为 0，或者写入失败
              */
-            std::size_t GetAllocatedSize() const
+            bool AsyncWrite(std::vector<uint8_t> &&data, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
-                return mem_.GetAllocatedSize();
+                auto ptr    = data.data();
+                auto length = data.size();
+                return PushOwnedTx(std::move(data), ptr, length, std::move(callback), request_id, priority);
             }
 
-        protected:
-            std::unique_ptr<driver::ByteDriver> driver_;
-
-            Mallocator_t mem_;
-
-            template <typename Data_t>
-            class QueueWithLock
+            /**
+             * @brief 异步写入，不会阻塞。可以在中断上下文中调用。发送 buffer 中的有效数据，不复制数据，请求结束后放弃对 buffer 的引用。
+             * @note buffer 通常由 AllocateTxBuffer() 分配并填好数据。发送期间不要再修改 buffer 中的数据
+             *
+             * @param buffer 要发送的缓冲区，发送 GetLength() 字节
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false buffer 为空或没有有效数据，或者写入失败
+             */
+            bool AsyncWrite(TxBuffer buffer, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
             {
-                using DataList_t = std::list<Data_t, AllocatorLimited<Data_t, Mallocator_t>>;
-
-            public:
-                stpp::CriticalSection lock;
-                std::queue<Data_t, DataList_t> queue;
-
-                QueueWithLock(AllocatorLimited<Data_t, Mallocator_t> allocator)
-                    : queue(std::move(allocator)) {};
-            };
-
-            using TxQueueWithLock = QueueWithLock<TxDataWithCallback>;
-            using RxQueueWithLock = QueueWithLock<RxDataWithCallback>;
-
-            TxQueueWithLock tx_queue_;
-            stpp::BinarySemphr tx_sem_{true}; // 当 driver_ 正在发送数据时，上锁
-
-            RxQueueWithLock rx_queue_;
-            stpp::BinarySemphr rx_sem_{true}; // 当 driver_ 正在接收数据时，上锁
+                if (!buffer || buffer.GetLength() == 0) {
+                    return false; // 空的句柄没有数据可发送，交给 driver_ 会以空指针或 0 长度出错
+                }
 
-            TaskHandle_t spin_task_handle_ = nullptr;
+                try {
+                    TxDataWithCallback data_with_cb(std::move(buffer), std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            }
 
-            void NotifySpinTaskFromThread()
+            /**
+             * @brief 从设备的发送缓冲池分配一个缓冲区，填好数据后交给 AsyncWrite(TxBuffer) 发送，省去一次复制。可以在中断上下文中调用。
+             *
+             * @param length 有效数据长度，单位字节
+             * @return TxBuffer 内存不足时返回空的句柄
+             */
+            TxBuffer AllocateTxBuffer(std::size_t length)
             {
-                assert(spin_task_handle_ != nullptr); // 你可能忘记了调用 Open()
-                xTaskNotifyGive(spin_task_handle_);
+                try {
+                    return tx_pool_.Allocate(length);
+                } catch (const std::bad_alloc &e) {
+                    return TxBuffer();
+                }
             }
 
-            void NotifySpinTaskFromISR()
+            /**
+             * @brief 格式化后异步写入，不会阻塞。直接格式化到从发送缓冲池分配的缓冲区中，不需要栈上的字符串，也不再复制一次。
+             *        可以在能调用 vsnprintf 的上下文中调用
+             * @note 先预留 kPrintfReserveLength 字节，结果更长或预留失败时按实际长度重新分配并再格式化一次。
+             *       实际长度也分配不到时返回 false，不会发送被截断的内容
+             * @note 格式化结果为空（如 AsyncPrintf("%s", "")）时没有要发送的数据，与 AsyncFormat() 相同，返回 false
+             *
+             * @return true 写入成功
+             * @return false 格式错误、结果为空、内存不足或队列已满
+             */
+            bool AsyncPrintf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+            {
+                va_list args;
+                va_start(args, format);
+                auto result = AsyncVPrintf(format, args);
+                va_end(args);
+                return result;
+            }
+
+            /**
+             * @brief AsyncPrintf() 的 va_list 版本，可以指定回调函数和优先级
+             *
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 格式错误、结果为空、内存不足或队列已满，回调函数不会被调用
+             */
+            bool AsyncVPrintf(const char *format, va_list args, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                va_list retry_args;
+                va_copy(retry_args, args);
+
+                int length  = -1;
+                auto buffer = AllocateTxBuffer(kPrintfReserveLength);
+                if (buffer) {
+                    length = std::vsnprintf(reinterpret_cast<char *>(buffer.GetData()), buffer.GetCapacity(), format, args);
+                } else {
+                    length = std::vsnprintf(nullptr, 0, format, args); // 缓冲池紧张，只分配实际需要的长度
+                }
+
+                if (length > 0 && static_cast<std::size_t>(length) >= buffer.GetCapacity()) {
+                    buffer.Reset(); // 先归还预留的缓冲区，再分配更大的
+                    buffer = AllocateTxBuffer(length + 1);
+                    if (buffer) {
+                        std::vsnprintf(reinterpret_cast<char *>(buffer.GetData()), length + 1, format, retry_args);
+                    }
+                }
+                va_end(retry_args);
+
+                if (length <= 0 || !buffer) {
+                    return false; // 格式错误、内存不足，或者格式化结果为空，没有要发送的数据
+                }
+
+                buffer.SetLength(length); // 不发送结尾的 '\0'
+                return AsyncWrite(std::move(buffer), std::move(callback), request_id, priority);
+            }
+
+            /**
+             * @brief 就地生成数据后异步写入，不会阻塞。可以在中断上下文中调用。用于 std::to_chars 等不经过 printf 的格式化
+             * @note 从发送缓冲池分配至少 max_length 字节，fill 直接写入其中并返回实际长度，只发送实际长度的数据
+             *
+             * @param max_length 最多生成的字节数
+             * @param fill 以 std::size_t(char *buffer, std::size_t capacity) 的形式写入数据，返回写入的字节数
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 内存不足、fill 返回 0 或队列已满，回调函数不会被调用
+             */
+            template <typename F>
+            bool AsyncFormat(std::size_t max_length, F &&fill, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                auto buffer = AllocateTxBuffer(max_length);
+                if (!buffer) {
+                    return false;
+                }
+
+                std::size_t length = fill(reinterpret_cast<char *>(buffer.GetData()), buffer.GetCapacity());
+                if (length == 0) {
+                    return false;
+                }
+
+                buffer.SetLength(length);
+                return AsyncWrite(std::move(buffer), std::move(callback), request_id, priority);
+            }
+
+            /**
+             * @brief 分散-聚集写入，不会阻塞。可以在中断上下文中调用。所有片段作为一个请求依次发送，只调用一次回调函数。
+             * @note 各片段会被依次复制到内部缓冲区的同一块内存中，调用者不需要事先拼接
+             *
+             * @param vecs 要发送的片段
+             * @param count 片段数
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 所有片段都为空，或者写入失败
+             */
+            bool AsyncWritev(const IoVec *vecs, std::size_t count, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                try {
+                    TxDataWithCallback data_with_cb(tx_pool_, vecs, count, std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            }
+
+            bool AsyncWritev(std::initializer_list<IoVec> vecs, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                return AsyncWritev(vecs.begin(), vecs.size(), std::move(callback), request_id, priority);
+            }
+
+            /**
+             * @brief 分散-聚集写入，不会阻塞。可以在中断上下文中调用。这个函数不会复制数据，各片段的数据必须保证在回调函数被调用之前一直有效。
+             * @note 最多支持 TxDataWithCallback::kMaxFragments 个非空片段
+             *
+             * @param vecs 要发送的片段，片段描述本身会被复制，调用后即可释放
+             * @param count 片段数
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级，高优先级的请求先发送
+             * @return true 写入成功
+             * @return false 所有片段都为空，或者写入失败
+             */
+            bool AsyncWritevNoCopy(const IoVec *vecs, std::size_t count, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                try {
+                    TxDataWithCallback data_with_cb(vecs, count, std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            }
+
+            bool AsyncWritevNoCopy(std::initializer_list<IoVec> vecs, CallbackFunc_t callback = CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal)
+            {
+                return AsyncWritevNoCopy(vecs.begin(), vecs.size(), std::move(callback), request_id, priority);
+            }
+
+            /**
+             * @brief 异步读取，用 request 跟踪请求的完成，不需要回调函数。可以在中断上下文中调用。
+             * @note request 在请求完成前必须一直有效。提交失败时 request 立即完成，结果为 ErrorCode::ERROR
+             *
+             * @param data 读取到的数据会保存在这里
+             * @param length 数据长度，单位字节
+             * @param request 请求的完成句柄
+             * @return true 成功
+             * @return false 失败
+             */
+            bool AsyncRead(void *data, std::size_t length, IoRequest &request)
+            {
+                return Submit(request, true, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncRead(data, length, std::move(callback), request_id);
+                });
+            }
+
+            bool AsyncReadUntil(void *data, std::size_t max_length, uint8_t delimiter, std::size_t *received_length, IoRequest &request)
+            {
+                return Submit(request, true, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncReadUntil(data, max_length, delimiter, received_length, std::move(callback), request_id);
+                });
+            }
+
+            /**
+             * @brief 异步写入，用 request 跟踪请求的完成，不需要回调函数。可以在中断上下文中调用。
+             * @note request 在请求完成前必须一直有效。提交失败时 request 立即完成，结果为 ErrorCode::ERROR
+             *
+             */
+            bool AsyncWrite(const void *data, std::size_t length, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return Submit(request, false, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncWrite(data, length, std::move(callback), request_id, priority);
+                });
+            }
+
+            bool AsyncWrite(const std::string_view str, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return AsyncWrite(str.data(), str.length(), request, priority);
+            }
+
+            /**
+             * @brief 不复制数据的异步写入，用 request 跟踪请求的完成。数据必须保证在请求完成之前一直有效。
+             *
+             */
+            bool AsyncWriteNoCopy(const void *data, std::size_t length, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return Submit(request, false, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncWriteNoCopy(data, length, std::move(callback), request_id, priority);
+                });
+            }
+
+            bool AsyncWriteNoCopy(const std::string_view str, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return AsyncWriteNoCopy(str.data(), str.length(), request, priority);
+            }
+
+            /**
+             * @brief 分散-聚集写入，用 request 跟踪请求的完成。
+             *
+             */
+            bool AsyncWritev(const IoVec *vecs, std::size_t count, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return Submit(request, false, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncWritev(vecs, count, std::move(callback), request_id, priority);
+                });
+            }
+
+            /**
+             * @brief 不复制数据的分散-聚集写入，用 request 跟踪请求的完成。各片段的数据必须保证在请求完成之前一直有效。
+             *
+             */
+            bool AsyncWritevNoCopy(const IoVec *vecs, std::size_t count, IoRequest &request, TxPriority priority = TxPriority::kNormal)
+            {
+                return Submit(request, false, [&](CallbackFunc_t callback, RequestId_t *request_id) {
+                    return AsyncWritevNoCopy(vecs, count, std::move(callback), request_id, priority);
+                });
+            }
+
+#if defined(__cpp_impl_coroutine)
+            /**
+             * @brief 在协程中读取：co_await dev.Read(data, length) 的结果是 stpp::ErrorCode。定义在 coro.hpp 中
+             *
+             */
+            coro::IoAwaitable Read(void *data, std::size_t length);
+
+            /**
+             * @brief 在协程中写入，不复制数据：co_await dev.Write(data, length) 的结果是 stpp::ErrorCode。定义在 coro.hpp 中
+             *
+             */
+            coro::IoAwaitable Write(const void *data, std::size_t length, TxPriority priority = TxPriority::kNormal);
+            coro::IoAwaitable Write(const std::string_view str, TxPriority priority = TxPriority::kNormal);
+#endif
+
+            /**
+             * @brief 分散-聚集同步写入，线程会阻塞直到所有片段发送完成。不能在中断上下文中调用。
+             *
+             * @param vecs 要发送的片段
+             * @param count 片段数
+             * @param timeout 超时时间，单位 ms。超时后请求会被取消，函数等到 driver_ 不再访问数据后才返回。
+             *        driver_ 不支持中止时，有限的 timeout 无法保证，直接返回 false
+             * @return true 写入成功
+             * @return false 写入失败、超时或被取消
+             */
+            bool SyncWritev(const IoVec *vecs, std::size_t count, uint32_t timeout = std::numeric_limits<uint32_t>::max())
+            {
+                if (InHandlerMode()) {
+                    throw std::runtime_error("SyncWritev() can't be called in interrupt context. Use AsyncWritev() instead.");
+                }
+
+                if (!IsTimeoutSupported(timeout, false)) {
+                    return false;
+                }
+
+                IoRequest request;
+                if (!AsyncWritevNoCopy(vecs, count, request)) {
+                    return false;
+                }
+
+                return WaitOrCancel(request, timeout);
+            }
+
+            bool SyncWritev(std::initializer_list<IoVec> vecs, uint32_t timeout = std::numeric_limits<uint32_t>::max())
+            {
+                return SyncWritev(vecs.begin(), vecs.size(), timeout);
+            }
+
+            /**
+             * @brief 批量提交读写请求，不会阻塞。可以在中断上下文中调用。
+             * @note 整批只进入一次临界区、最多通知守护线程一次，复制写入的数据只分配一次缓冲区。
+             *       每个请求仍然单独完成、单独调用回调函数，与逐个调用 Async* 函数的效果相同
+             * @note 按顺序提交，遇到队列已满时停止，之后的请求不提交，回调函数也不会被调用。
+             *       遇到长度为 0 的写请求或流式接收时长度不小于环形缓冲区的读请求时同样停止
+             *
+             * @param entries 要提交的请求，已提交的请求的回调函数会被移走
+             * @param count 请求数
+             * @return std::size_t 成功提交的请求数
+             */
+            std::size_t SubmitBatch(BatchEntry *entries, std::size_t count)
+            {
+                std::size_t copy_length = 0;
+                std::size_t tx_length   = 0;
+                for (std::size_t i = 0; i < count; i++) {
+                    auto &entry = entries[i];
+                    if (entry.kind == BatchEntry::Kind::kRead) {
+                        if (rx_stream_ != nullptr && entry.length > rx_stream_->GetMaxReadLength()) {
+                            count = i; // 流式接收时永远不会满足，只提交之前的请求
+                            break;
+                        }
+                        continue;
+                    }
+
+                    if (entry.length == 0) {
+                        count = i; // 同 AsyncWrite()，没有数据可发送
+                        break;
+                    }
+
+                    tx_length += entry.length;
+                    if (entry.kind == BatchEntry::Kind::kWrite) {
+                        copy_length += entry.length;
+                    }
+                }
+
+                // 先在临界区外把所有要复制的数据复制到同一个缓冲区
+                TxBuffer copy_buffer;
+                if (copy_length != 0) {
+                    try {
+                        copy_buffer = tx_pool_.Allocate(copy_length);
+                    } catch (const std::exception &e) {
+                        return 0;
+                    }
+
+                    auto ptr = copy_buffer.GetData();
+                    for (std::size_t i = 0; i < count; i++) {
+                        if (entries[i].kind == BatchEntry::Kind::kWrite) {
+                            std::memcpy(ptr, entries[i].data, entries[i].length);
+                            ptr += entries[i].length;
+                        }
+                    }
+                }
+
+                // 同 PushTx()，先计入再入队
+                tx_queued_size_.fetch_add(tx_length);
+
+                std::size_t submitted = 0;
+                std::size_t pushed_tx = 0;
+                bool has_rx           = false;
+                auto now              = GetStatsTime();
+                {
+                    std::lock_guard tx_lock(tx_queue_.lock);
+                    std::lock_guard rx_lock(rx_queue_.lock);
+
+                    auto copy_ptr = copy_buffer.GetData();
+                    for (; submitted < count; submitted++) {
+                        auto &entry = entries[submitted];
+                        auto id     = NewRequestId();
+
+                        if (entry.kind == BatchEntry::Kind::kRead) {
+                            if (rx_queue_.queue.IsFull()) break;
+
+                            RxDataWithCallback rx_data(static_cast<uint8_t *>(entry.data), entry.length, std::move(entry.callback));
+                            rx_data.id_           = id;
+                            rx_data.enqueue_time_ = now;
+                            rx_queue_.queue.PushBack(std::move(rx_data));
+                            STPP_IO_TRACE_EVENT(kRxEnqueue, trace_id_, id, entry.length);
+                            has_rx = true;
+                        } else {
+                            auto &lane = tx_queue_.GetLane(entry.priority);
+                            if (lane.IsFull()) break;
+
+                            auto data = static_cast<const uint8_t *>(entry.data);
+                            if (entry.kind == BatchEntry::Kind::kWrite) {
+                                data = copy_ptr;
+                                copy_ptr += entry.length;
+                            }
+
+                            TxDataWithCallback tx_data(data, entry.length, std::move(entry.callback));
+                            if (entry.kind == BatchEntry::Kind::kWrite) {
+                                tx_data.buffer_    = copy_buffer; // 只增加引用计数，最后一个请求完成时缓冲区回到缓冲池
+                                tx_data.is_copied_ = true;
+                            }
+                            tx_data.id_           = id;
+                            tx_data.priority_     = entry.priority;
+                            tx_data.enqueue_time_ = now;
+                            lane.PushBack(std::move(tx_data));
+                            pushed_tx += entry.length;
+                            STPP_IO_TRACE_EVENT(kTxEnqueue, trace_id_, id, entry.length);
+                        }
+
+                        if (entry.request_id != nullptr) {
+                            *entry.request_id = id;
+                        }
+                    }
+
+                    IoStatsCounters::UpdateMax(stats_.tx_queue_high_water, tx_queue_.GetSize());
+                    IoStatsCounters::UpdateMax(stats_.rx_queue_high_water, rx_queue_.queue.GetSize());
+                }
+
+                if (pushed_tx != tx_length) {
+                    tx_queued_size_.fetch_sub(tx_length - pushed_tx);
+                }
+
+                if (pushed_tx != 0) {
+                    CheckTxHighWatermark();
+                }
+                if (!is_opened_) {
+                    return submitted; // 同 PushTx()
+                }
+
+                uint32_t events = 0;
+                if (pushed_tx != 0) {
+                    if (!DispatchTx()) {
+                        events |= kTxRequest;
+                    }
+                }
+                if (has_rx && !DispatchRx()) {
+                    events |= kRxRequest;
+                }
+
+                if (events != 0) {
+                    NotifySpinTask(events); // 整批只通知一次
+                }
+                return submitted;
+            }
+
+            template <std::size_t N>
+            std::size_t SubmitBatch(BatchEntry (&entries)[N])
+            {
+                return SubmitBatch(entries, N);
+            }
+
+            /**
+             * @brief 取消读请求。可以在中断上下文中调用
+             * @note 排队中的请求直接移出队列；正在接收的请求由 driver_ 中止。回调函数收到 ErrorCode::CANCELLED
+             *
+             * @param request_id Async* 函数保存的请求 id
+             * @return true 请求已取消，或正在中止，稍后会调用回调函数
+             * @return false 请求已完成，或 driver_ 不支持中止
+             */
+            bool CancelRead(RequestId_t request_id)
+            {
+                RxDataWithCallback rx_data;
+                if (TakeQueued(rx_queue_.lock, rx_queue_.queue, request_id, rx_data)) {
+                    IoStatsCounters::Add(stats_.rx_errors);
+                    STPP_IO_TRACE_EVENT(kRxCallbackBegin, trace_id_, request_id, static_cast<uint32_t>(stpp::ErrorCode::CANCELLED));
+                    if (rx_data.callback_) {
+                        rx_data.callback_(stpp::ErrorCode::CANCELLED);
+                    }
+                    STPP_IO_TRACE_EVENT(kRxCallbackEnd, trace_id_, request_id, 0);
+                    return true;
+                }
+
+                // 在临界区中检查并中止，保证中止的一定是这个请求的传输，而不是之后开始的传输
+                std::lock_guard lock(transfer_lock_);
+                if (request_id == kInvalidRequestId || rx_transfer_id_ != request_id) {
+                    return false;
+                }
+                return driver_->AbortRead();
+            }
+
+            /**
+             * @brief 取消写请求。可以在中断上下文中调用
+             * @note 排队中的请求直接移出队列；正在发送的请求由 driver_ 中止。回调函数收到 ErrorCode::CANCELLED。
+             *       已合并进暂存区的请求数据已经复制，不能取消
+             *
+             * @param request_id Async* 函数保存的请求 id
+             * @return true 请求已取消，或正在中止，稍后会调用回调函数
+             * @return false 请求已完成、已合并发送，或 driver_ 不支持中止
+             */
+            bool CancelWrite(RequestId_t request_id)
+            {
+                TxDataWithCallback tx_data;
+                for (auto &lane : tx_queue_.lanes) {
+                    if (TakeQueued(tx_queue_.lock, lane, request_id, tx_data)) {
+                        IoStatsCounters::Add(stats_.tx_errors);
+                        STPP_IO_TRACE_EVENT(kTxCallbackBegin, trace_id_, request_id, static_cast<uint32_t>(stpp::ErrorCode::CANCELLED));
+                        if (tx_data.callback_) {
+                            tx_data.callback_(stpp::ErrorCode::CANCELLED);
+                        }
+                        STPP_IO_TRACE_EVENT(kTxCallbackEnd, trace_id_, request_id, 0);
+                        ReleaseTxQueuedSize(tx_data.length_);
+                        return true;
+                    }
+                }
+
+                std::lock_guard lock(transfer_lock_);
+                if (request_id == kInvalidRequestId || tx_transfer_id_ != request_id) {
+                    return false;
+                }
+                return driver_->AbortWrite();
+            }
+
+            driver::ByteDriver *GetDriver() const
+            {
+                return driver_.get();
+            }
+
+            /**
+             * @brief 获取已分配的内存大小
+             * @note 复制模式的发送缓冲区用完后留在缓冲池中复用，所以这里包括暂时空闲的缓冲区
+             *
+             * @return std::size_t
+             */
+            std::size_t GetAllocatedSize() const
+            {
+                return mem_.GetAllocatedSize();
+            }
+
+            /**
+             * @brief 设置统计延迟用的时钟，如 HPT_GetTotalSysTick。不设置时只统计计数，不统计延迟
+             * @note 必须在提交任何请求之前调用。时钟函数会在中断中被调用
+             *
+             */
+            void SetStatsClock(StatsClockFunc_t clock)
+            {
+                stats_clock_ = clock;
+            }
+
+            /**
+             * @brief 获取统计数据的快照。可以在任何上下文中调用
+             * @note 各计数器分别读取，快照不是严格一致的
+             *
+             */
+            void GetStats(IoStats &stats) const
+            {
+                stats_.Snapshot(stats);
+                stats.alloc_failures = tx_pool_.GetAllocFailureCount() - alloc_failures_base_;
+                stats.rx_overflows   = rx_stream_ == nullptr ? 0 : rx_stream_->GetOverflowCount();
+            }
+
+            /**
+             * @brief 清零统计数据
+             *
+             */
+            void ResetStats()
+            {
+                stats_.Reset();
+                alloc_failures_base_ = tx_pool_.GetAllocFailureCount();
+            }
+
+        protected:
+            std::unique_ptr<driver::ByteDriver> driver_;
+
+            Mallocator_t mem_;
+            device_framework_internal::TxBufferPool<Mallocator_t> tx_pool_; // 复制模式的发送缓冲区，从 mem_ 分配。必须在各队列之前构造
+
+            template <typename Data_t>
+            class QueueWithLock
+            {
+            public:
+                stpp::CriticalSection lock;
+                stpp::RingQueue<Data_t> queue;
+
+                QueueWithLock(std::size_t capacity)
+                    : queue(capacity) {};
+            };
+
+            /**
+             * @brief 发送队列：每个优先级一条队列，共用一把锁
+             *
+             */
+            class TxLanesWithLock
+            {
+            public:
+                stpp::CriticalSection lock;
+                stpp::RingQueue<TxDataWithCallback> lanes[device::kTxPriorityCount];
+
+                TxLanesWithLock(std::size_t capacity)
+                    : lanes{stpp::RingQueue<TxDataWithCallback>(capacity),
+                            stpp::RingQueue<TxDataWithCallback>(capacity),
+                            stpp::RingQueue<TxDataWithCallback>(capacity)}
+                {
+                    static_assert(device::kTxPriorityCount == 3, "Update the initializer of lanes");
+                }
+
+                stpp::RingQueue<TxDataWithCallback> &GetLane(TxPriority priority)
+                {
+                    return lanes[static_cast<std::size_t>(priority)];
+                }
+
+                /**
+                 * @brief 获取优先级最高的非空队列，都为空时返回 nullptr
+                 *
+                 */
+                stpp::RingQueue<TxDataWithCallback> *GetHighestLane()
+                {
+                    for (auto i = device::kTxPriorityCount; i-- > 0;) {
+                        if (!lanes[i].IsEmpty()) {
+                            return &lanes[i];
+                        }
+                    }
+                    return nullptr;
+                }
+
+                bool HasHigherThan(TxPriority priority)
+                {
+                    for (auto i = static_cast<std::size_t>(priority) + 1; i < device::kTxPriorityCount; i++) {
+                        if (!lanes[i].IsEmpty()) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                bool IsEmpty()
+                {
+                    return GetHighestLane() == nullptr;
+                }
+
+                /**
+                 * @brief 所有队列中的请求总数
+                 *
+                 */
+                std::size_t GetSize()
+                {
+                    std::size_t size = 0;
+                    for (auto &lane : lanes) {
+                        size += lane.GetSize();
+                    }
+                    return size;
+                }
+            };
+
+            using RxQueueWithLock = QueueWithLock<RxDataWithCallback>;
+
+            TxLanesWithLock tx_queue_;
+            stpp::BinarySemphr tx_sem_{true}; // 当 driver_ 正在发送数据时，上锁
+
+            stpp::RingQueue<TxDataWithCallback> tx_inflight_;     // 正在发送的请求，只有持有 tx_sem_ 时才能访问
+            std::unique_ptr<stpp::ContinuousBuffer> tx_staging_; // 合并发送的暂存区，为空时不合并
+            bool is_tx_coalesced_      = false;                  // 正在发送的是不是合并后的暂存区
+            std::size_t tx_chunk_size_ = 0;                      // 分段发送的大小，为 0 时不分段
+
+            std::atomic<std::size_t> tx_queued_size_{0}; // 排队和正在发送的数据总长度
+            std::size_t tx_high_watermark_ = 0;
+            std::size_t tx_low_watermark_  = 0;
+            WatermarkCallbackFunc_t tx_watermark_cb_;
+            std::atomic<bool> is_tx_above_high_{false};
+
+            stpp::CriticalSection writable_waiters_lock_;
+            TaskHandle_t writable_waiters_[kMaxWritableWaiters] = {}; // 阻塞在 WaitWritable() 中的线程
+
+            RxQueueWithLock rx_queue_;
+            stpp::BinarySemphr rx_sem_{true}; // 当 driver_ 正在接收数据时，上锁
+            RxDataWithCallback rx_active_;     // 正在接收的请求，只有持有 rx_sem_ 时才能访问
+
+            static constexpr RequestId_t kBatchTransferId = std::numeric_limits<RequestId_t>::max(); // 合并发送的传输，不能取消
+
+            using IoStatsCounters = device_framework_internal::IoStatsCounters;
+
+            StatsClockFunc_t stats_clock_ = nullptr;
+            IoStatsCounters stats_;
+            uint32_t alloc_failures_base_ = 0; // ResetStats() 时缓冲池的分配失败次数
+
+#ifdef STPP_IO_TRACE
+            uint8_t trace_id_ = io_trace::AllocateDeviceId();
+#endif
+
+            std::atomic<RequestId_t> next_request_id_{1};
+            stpp::CriticalSection transfer_lock_;        // 开始传输与取消传输互斥
+            std::atomic<RequestId_t> tx_transfer_id_{0}; // driver_ 正在发送的请求 id，没有传输时为 0
+            std::atomic<RequestId_t> rx_transfer_id_{0}; // driver_ 正在接收的请求 id，没有传输时为 0
+
+            std::unique_ptr<device_framework_internal::StreamRxRing> rx_stream_; // 流式接收的环形缓冲区，为空时不在流式接收，只有持有 rx_sem_ 时才能读出
+            CallbackFunc_t rx_data_cb_;                                          // 流式接收的新数据回调
+            uint32_t rx_data_seen_ = 0;                                          // 上次调用新数据回调时的累计写入字节数
+
+            /**
+             * @brief 请求的调度方式
+             *
+             */
+            enum class DispatchMode {
+                kDaemon,    // 由守护线程调度
+                kInterrupt, // 没有守护线程，在调用者或完成中断的上下文中调度
+                kScheduler, // 由 IoScheduler 调度
+            };
+
+            DispatchMode dispatch_mode_    = DispatchMode::kDaemon;
+            TaskHandle_t spin_task_handle_ = nullptr;
+            std::atomic<bool> is_opened_{false}; // 为 false 时 driver_ 的完成回调还没有设置，请求只入队，打开时再开始传输
+
+            IoScheduler *scheduler_     = nullptr;
+            std::size_t scheduler_slot_ = 0;
+
+            std::atomic<uint32_t> pending_events_{0}; // 等待 IoScheduler 处理的 SpinEvent
+
+            friend class IoScheduler;
+
+            void AttachScheduler(IoScheduler *scheduler, std::size_t slot)
+            {
+                dispatch_mode_  = DispatchMode::kScheduler;
+                scheduler_      = scheduler;
+                scheduler_slot_ = slot;
+                pending_events_ = kTxRequest | kRxRequest; // 防止在注册之前有数据
+                SetDriverCallbacks();
+                is_opened_ = true;
+            }
+
+            /**
+             * @brief 由 IoScheduler 的线程调用，处理积累的事件
+             *
+             */
+            void HandleSchedulerEvents()
+            {
+                HandleEvents(pending_events_.exchange(0));
+            }
+
+            void SetDriverCallbacks()
+            {
+                driver_->SetWriteCpltCb([this](stpp::ErrorCode ec) {
+                    OnTxComplete(ec);
+                });
+                driver_->SetReadCpltCb([this](stpp::ErrorCode ec) {
+                    OnRxComplete(ec);
+                });
+            }
+
+            RequestId_t NewRequestId()
+            {
+                RequestId_t request_id;
+                do {
+                    request_id = next_request_id_.fetch_add(1);
+                } while (request_id == kInvalidRequestId || request_id == kBatchTransferId);
+                return request_id;
+            }
+
+            uint32_t GetStatsTime() const
+            {
+                return stats_clock_ == nullptr ? 0 : stats_clock_();
+            }
+
+            /**
+             * @brief 记录从 since 到 now 的延迟。没有设置统计时钟时不记录
+             *
+             */
+            void RecordLatency(device_framework_internal::AtomicHistogram &histogram, uint32_t since, uint32_t now)
+            {
+                if (stats_clock_ != nullptr) {
+                    histogram.Record(now - since);
+                }
+            }
+
+            /**
+             * @brief 统计完成的写请求
+             *
+             */
+            void CountTxDone(const TxDataWithCallback &tx_data, stpp::ErrorCode ec, uint32_t now)
+            {
+                if (ec == stpp::ErrorCode::OK) {
+                    IoStatsCounters::Add(stats_.tx_bytes, tx_data.length_);
+                    IoStatsCounters::Add(stats_.tx_requests);
+                } else {
+                    IoStatsCounters::Add(stats_.tx_errors);
+                }
+                RecordLatency(stats_.tx_service_latency, tx_data.start_time_, now);
+            }
+
+            bool PushTx(TxDataWithCallback &&data_with_cb, RequestId_t *request_id, TxPriority priority)
+            {
+                if (data_with_cb.IsEmpty()) {
+                    return false; // 同 AsyncWrite(TxBuffer)，没有数据可发送，NextChunk() 也取不到有效的片段
+                }
+
+                auto id                    = NewRequestId();
+                auto length                = data_with_cb.length_;
+                data_with_cb.id_           = id;
+                data_with_cb.priority_     = priority;
+                data_with_cb.enqueue_time_ = GetStatsTime();
+
+                // 先保存 id 再入队：请求一入队就可能被快速路径或中断开始并完成，回调中可能已用到这个 id
+                if (request_id != nullptr) {
+                    *request_id = id;
+                }
+
+                // 先计入再入队，以免请求在计入之前就已发送完
+                tx_queued_size_.fetch_add(length);
+
+                bool is_pushed;
+                {
+                    std::lock_guard lock(tx_queue_.lock);
+                    is_pushed = tx_queue_.GetLane(priority).PushBack(std::move(data_with_cb));
+                    IoStatsCounters::UpdateMax(stats_.tx_queue_high_water, tx_queue_.GetSize());
+                }
+
+                if (!is_pushed) {
+                    tx_queued_size_.fetch_sub(length);
+                    if (request_id != nullptr) {
+                        *request_id = kInvalidRequestId;
+                    }
+                    return false;
+                }
+
+                CheckTxHighWatermark();
+                STPP_IO_TRACE_EVENT(kTxEnqueue, trace_id_, id, length);
+
+                // 打开之前不能开始传输，否则传输完成时没有回调。打开时会处理已入队的请求
+                if (!is_opened_) {
+                    return true;
+                }
+
+                // 快速路径：driver_ 空闲时直接在调用者的上下文中开始传输，省去唤醒守护线程的延迟
+                if (!DispatchTx()) {
+                    NotifySpinTask(kTxRequest); // driver_ 被占用，交给守护线程
+                }
+                return true;
+            }
+
+            /**
+             * @brief 把 owner 移入发送缓冲池的一个缓冲区，再把 data 指向的数据作为一个请求入队
+             * @note 入队失败时 owner 随缓冲区一起析构。缓冲区分配失败时 owner 不会被移动
+             */
+            template <typename Owner_t>
+            bool PushOwnedTx(Owner_t &&owner, const uint8_t *data, std::size_t length, CallbackFunc_t callback, RequestId_t *request_id, TxPriority priority)
+            {
+                try {
+                    TxDataWithCallback data_with_cb(tx_pool_, std::forward<Owner_t>(owner), data, length, std::move(callback));
+                    return PushTx(std::move(data_with_cb), request_id, priority);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            }
+
+            bool PushRx(RxDataWithCallback &&data_with_cb, RequestId_t *request_id)
+            {
+                auto id                      = NewRequestId();
+                [[maybe_unused]] auto length = data_with_cb.length_;
+                data_with_cb.id_             = id;
+                data_with_cb.enqueue_time_   = GetStatsTime();
+
+                // 同 PushTx，先保存 id 再入队
+                if (request_id != nullptr) {
+                    *request_id = id;
+                }
+
+                bool is_pushed;
+                {
+                    std::lock_guard lock(rx_queue_.lock);
+                    is_pushed = rx_queue_.queue.PushBack(std::move(data_with_cb));
+                    IoStatsCounters::UpdateMax(stats_.rx_queue_high_water, rx_queue_.queue.GetSize());
+                }
+
+                if (!is_pushed) {
+                    if (request_id != nullptr) {
+                        *request_id = kInvalidRequestId;
+                    }
+                    return false;
+                }
+                STPP_IO_TRACE_EVENT(kRxEnqueue, trace_id_, id, length);
+
+                // 同 PushTx()
+                if (!is_opened_) {
+                    return true;
+                }
+
+                if (!DispatchRx()) {
+                    NotifySpinTask(kRxRequest);
+                }
+                return true;
+            }
+
+            /**
+             * @brief 守护线程的通知位。守护线程只在收到通知时运行，没有轮询
+             *
+             */
+            enum SpinEvent : uint32_t {
+                kTxRequest  = 1u << 0, // 有新的写请求
+                kRxRequest  = 1u << 1, // 有新的读请求
+                kTxComplete = 1u << 2, // driver_ 发送完成
+                kRxComplete = 1u << 3, // driver_ 接收完成
+            };
+
+            void NotifySpinTaskFromThread(uint32_t events)
+            {
+                assert(spin_task_handle_ != nullptr); // 你可能忘记了调用 Open()
+                xTaskNotify(spin_task_handle_, events, eSetBits);
+            }
+
+            void NotifySpinTaskFromISR(uint32_t events)
+            {
+                assert(spin_task_handle_ != nullptr); // 你可能忘记了调用 Open()
+
+                // 通知守护线程传输
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+                xTaskNotifyFromISR(spin_task_handle_, events, eSetBits, &xHigherPriorityTaskWoken);
+                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            }
+
+            void NotifySpinTask(uint32_t events)
+            {
+                if (dispatch_mode_ == DispatchMode::kInterrupt) {
+                    HandleEvents(events); // 没有守护线程，直接在当前上下文中调度
+                    return;
+                }
+
+                if (dispatch_mode_ == DispatchMode::kScheduler) {
+                    pending_events_.fetch_or(events);
+                    scheduler_->Notify(scheduler_slot_);
+                    return;
+                }
+
+                if (InHandlerMode()) {
+                    NotifySpinTaskFromISR(events);
+                } else {
+                    NotifySpinTaskFromThread(events);
+                }
+            }
+
+            /**
+             * @brief 让 driver_ 开始发送，并记录正在发送的请求 id 以便取消
+             *
+             */
+            bool StartTxTransfer(const uint8_t *data, std::size_t length, RequestId_t request_id)
             {
-                assert(spin_task_handle_ != nullptr); // 你可能忘记了调用 Open()
+                std::lock_guard lock(transfer_lock_);
+                if (!this->driver_->AsyncWrite(data, length)) {
+                    return false;
+                }
+                tx_transfer_id_ = request_id;
+                IoStatsCounters::Add(stats_.tx_transfers);
+                STPP_IO_TRACE_EVENT(kTxStart, trace_id_, request_id, length);
+                return true;
+            }
 
-                // 通知守护线程传输
-                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                vTaskNotifyGiveFromISR(spin_task_handle_, &xHigherPriorityTaskWoken);
-                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            /**
+             * @brief 开始发送请求的下一段数据
+             *
+             */
+            bool StartTxChunk(TxDataWithCallback &tx_data)
+            {
+                auto max_length = tx_data.priority_ == TxPriority::kHigh ? 0 : tx_chunk_size_;
+                auto chunk      = tx_data.NextChunk(max_length);
+                return StartTxTransfer(static_cast<const uint8_t *>(chunk.data), chunk.length, tx_data.id_);
             }
 
-            void NotifySpinTask()
+            /**
+             * @brief 分段发送的请求发送完一段后，如果有更高优先级的请求在排队，把它放回所在队列的头部并释放 driver_
+             *
+             * @return true 已让出 driver_
+             * @return false 没有更高优先级的请求，或队列已满放不回去，应继续发送
+             */
+            bool YieldTxToHigherPriority()
             {
-                if (InHandlerMode()) {
-                    NotifySpinTaskFromISR();
-                } else {
-                    NotifySpinTaskFromThread();
+                if (tx_chunk_size_ == 0) {
+                    return false;
+                }
+
+                {
+                    std::lock_guard lock(tx_queue_.lock);
+                    auto &tx_data = tx_inflight_.Front();
+                    if (!tx_queue_.HasHigherThan(tx_data.priority_) || !tx_queue_.GetLane(tx_data.priority_).PushFront(std::move(tx_data))) {
+                        return false;
+                    }
+                    tx_inflight_.Clear();
                 }
+
+                this->tx_sem_.unlock();
+                NotifySpinTask(kTxComplete);
+                return true;
             }
 
-            friend void stpp::device_framework_internal::ByteDeviceDaemon(void *argument);
+            /**
+             * @brief 从优先级最高的非空发送队列中取出下一批请求放入 tx_inflight_。调用时需要持有 tx_queue_.lock
+             * @note 开启合并发送时，一批包含队列头部所有能放进暂存区的连续复制模式请求；否则一批只有一个请求
+             *
+             * @return std::size_t 取出的请求数
+             */
+            std::size_t PopTxBatch()
+            {
+                auto lane = tx_queue_.GetHighestLane();
+                if (lane == nullptr) {
+                    return 0;
+                }
 
-            void Spin()
+                auto &queue = *lane;
+                TxDataWithCallback tx_data;
+                std::size_t count = 0;
+
+                if (tx_staging_ != nullptr) {
+                    std::size_t total_length = 0;
+                    while (!queue.IsEmpty() && queue.Front().is_copied_ && !queue.Front().IsStarted() && total_length + queue.Front().length_ <= tx_staging_->GetCapacity()) {
+                        total_length += queue.Front().length_;
+                        queue.PopFront(tx_data);
+                        tx_inflight_.PushBack(std::move(tx_data));
+                        count++;
+                    }
+                }
+
+                if (count == 0 && queue.PopFront(tx_data)) {
+                    tx_inflight_.PushBack(std::move(tx_data));
+                    count++;
+                }
+
+                return count;
+            }
+
+            /**
+             * @brief 开始发送 tx_inflight_ 中的请求。多于一个请求时先把数据复制到暂存区，再一次发出
+             *
+             */
+            bool StartTxBatch()
+            {
+                auto now = GetStatsTime();
+                for (std::size_t i = 0; i < tx_inflight_.GetSize(); i++) {
+                    auto &tx_data = tx_inflight_[i];
+                    if (!tx_data.IsStarted()) {
+                        tx_data.start_time_ = now; // 让出后重新开始的请求不重复统计
+                        RecordLatency(stats_.tx_queue_latency, tx_data.enqueue_time_, now);
+                    }
+                }
+
+                is_tx_coalesced_ = tx_inflight_.GetSize() > 1;
+
+                if (!is_tx_coalesced_) {
+                    return StartTxChunk(tx_inflight_.Front());
+                }
+
+                tx_staging_->Clear();
+                for (std::size_t i = 0; i < tx_inflight_.GetSize(); i++) {
+                    auto &tx_data = tx_inflight_[i];
+                    tx_staging_->PushBack(static_cast<const uint8_t *>(tx_data.fragments_[0].data), tx_data.length_);
+                    tx_data.buffer_.Reset(); // 数据已在暂存区中，提前归还缓冲池
+                }
+
+                auto [data, length] = tx_staging_->GetBuffer();
+                return StartTxTransfer(data, length, kBatchTransferId);
+            }
+
+            /**
+             * @brief 结束 tx_inflight_ 中的所有请求，依次调用回调函数，释放 driver_ 并通知守护线程发送下一批
+             *
+             */
+            void FinishTxBatch(stpp::ErrorCode ec)
             {
                 TxDataWithCallback tx_data;
-                RxDataWithCallback rx_data;
+                std::size_t length = 0;
+                auto now           = GetStatsTime();
+                while (tx_inflight_.PopFront(tx_data)) {
+                    length += tx_data.length_;
+                    CountTxDone(tx_data, ec, now);
+                    STPP_IO_TRACE_EVENT(kTxCallbackBegin, trace_id_, tx_data.id_, static_cast<uint32_t>(ec));
+                    if (tx_data.callback_) {
+                        tx_data.callback_(ec);
+                    }
+                    STPP_IO_TRACE_EVENT(kTxCallbackEnd, trace_id_, tx_data.id_, 0);
+                }
+                this->tx_sem_.unlock();
+                ReleaseTxQueuedSize(length);
+                NotifySpinTask(kTxComplete);
+            }
+
+            void OnTxComplete(stpp::ErrorCode ec)
+            {
+                auto transfer_id = tx_transfer_id_.exchange(0);
+                if (transfer_id == kInvalidRequestId) {
+                    return; // 中止与传输完成同时发生时，driver_ 可能多报告一次
+                }
+                STPP_IO_TRACE_EVENT(kTxIrq, trace_id_, transfer_id, static_cast<uint32_t>(ec));
+
+                if (!is_tx_coalesced_) {
+                    auto &tx_data = tx_inflight_.Front();
+                    if (ec == stpp::ErrorCode::OK && tx_data.FinishChunk()) {
+                        if (YieldTxToHigherPriority() || StartTxChunk(tx_data)) {
+                            return; // 让出 driver_ 或继续发送剩余的数据，发送完所有数据后才调用回调函数
+                        }
+                        ec = stpp::ErrorCode::ERROR;
+                    }
+                }
 
-                NotifySpinTaskFromThread(); // 防止在 Spin 之前有数据
+                FinishTxBatch(ec);
+            }
+
+            friend void stpp::device_framework_internal::ByteDeviceDaemon(void *argument);
 
+            /**
+             * @brief 如果 driver_ 空闲且队列中有写请求，开始发送下一批请求。可以在任务或中断上下文中调用
+             *
+             * @return true 成功占用了 driver_，队列中已有的请求都已经或正在被处理
+             * @return false driver_ 被占用
+             */
+            bool DispatchTx()
+            {
                 while (true) {
-                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-                    if (tx_sem_.lock_from_thread(0)) { // driver_ 能够发送数据
-                        std::unique_lock lock{tx_queue_.lock};
-                        auto queue_size = tx_queue_.queue.size();
-                        if (queue_size > 0) { // 有数据需要发送
-                            tx_data = std::move(tx_queue_.queue.front());
-                            tx_queue_.queue.pop();
-                            lock.unlock();
-
-                            this->driver_->SetWriteCpltCb([this, &tx_data](stpp::ErrorCode ec) {
-                                if (tx_data.callback_) {
-                                    tx_data.callback_(ec);
-                                }
-                                this->tx_sem_.unlock();
-                            });
-
-                            this->driver_->AsyncWrite(tx_data.data_.get(), tx_data.length_);
-
-                            if (queue_size > 1) {
-                                NotifySpinTaskFromThread(); // 还有数据需要发送，下一轮继续检查
-                            }
-                        } else {
-                            tx_sem_.unlock();
+                    if (!tx_sem_.lock(0)) {
+                        return false; // driver_ 正忙，发送完成后会收到 kTxComplete
+                    }
+
+                    std::size_t batch_size;
+                    {
+                        std::lock_guard lock(tx_queue_.lock);
+                        batch_size = PopTxBatch();
+                    }
+
+                    if (batch_size != 0) {
+                        if (!StartTxBatch()) {
+                            FinishTxBatch(stpp::ErrorCode::ERROR);
                         }
-                    } else {
-                        NotifySpinTaskFromThread(); // driver_ 正忙，下一轮继续检查
-                        vTaskDelay(1);
+                        return true;
+                    }
+
+                    tx_sem_.unlock();
+
+                    // 占用 driver_ 期间可能有新请求入队，而入队者没能占用 driver_，释放后需要再检查一次
+                    std::lock_guard lock(tx_queue_.lock);
+                    if (tx_queue_.IsEmpty()) {
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * @brief 如果 driver_ 空闲且队列中有读请求，开始接收。可以在任务或中断上下文中调用
+             *
+             * @return true 成功占用了 driver_
+             * @return false driver_ 被占用
+             */
+            bool DispatchRx()
+            {
+                if (rx_stream_ != nullptr) {
+                    return ServeStreamReads();
+                }
+
+                while (true) {
+                    if (!rx_sem_.lock(0)) {
+                        return false; // driver_ 正忙，接收完成后会收到 kRxComplete
+                    }
+
+                    bool is_popped;
+                    {
+                        std::lock_guard lock(rx_queue_.lock);
+                        is_popped = rx_queue_.queue.PopFront(rx_active_);
+                    }
+
+                    if (is_popped) {
+                        rx_active_.start_time_ = GetStatsTime();
+                        RecordLatency(stats_.rx_queue_latency, rx_active_.enqueue_time_, rx_active_.start_time_);
+                        if (!StartRxTransfer()) {
+                            FinishRx(stpp::ErrorCode::ERROR);
+                        }
+                        return true;
                     }
 
-                    if (rx_sem_.lock_from_thread(0)) { // driver_ 能够接收数据
-                        std::unique_lock lock{rx_queue_.lock};
-                        auto queue_size = rx_queue_.queue.size();
-                        if (queue_size > 0) { // 有数据需要接收
-                            rx_data = std::move(rx_queue_.queue.front());
-                            rx_queue_.queue.pop();
-                            lock.unlock();
+                    rx_sem_.unlock();
 
-                            this->driver_->SetReadCpltCb([this, &rx_data](stpp::ErrorCode ec) {
-                                if (rx_data.callback_) {
-                                    rx_data.callback_(ec);
-                                }
-                                this->rx_sem_.unlock();
-                            });
+                    // 同 DispatchTx()
+                    std::lock_guard lock(rx_queue_.lock);
+                    if (rx_queue_.queue.IsEmpty()) {
+                        return true;
+                    }
+                }
+            }
 
-                            this->driver_->AsyncRead(rx_data.data_.get(), rx_data.length_);
+            /**
+             * @brief 流式接收时，用环形缓冲区中的数据依次完成读请求，直到数据不够下一个请求
+             *
+             */
+            bool ServeStreamReads()
+            {
+                while (true) {
+                    if (!rx_sem_.lock(0)) {
+                        return false; // 其他上下文正在读出，新数据到来时会收到 kRxComplete
+                    }
 
-                            if (queue_size > 1) {
-                                NotifySpinTaskFromThread(); // 还有数据需要发送，下一轮继续检查
+                    while (true) {
+                        std::size_t length;
+                        {
+                            std::lock_guard lock(rx_queue_.lock);
+                            if (rx_queue_.queue.IsEmpty()) {
+                                break;
                             }
-                        } else {
-                            rx_sem_.unlock();
+                            length = GetStreamReadLength(rx_queue_.queue.Front());
+                            if (length == 0) {
+                                break;
+                            }
+                            rx_queue_.queue.PopFront(rx_active_);
                         }
-                    } else {
-                        NotifySpinTaskFromThread(); // driver_ 正忙，下一轮继续检查
-                        vTaskDelay(1);
+
+                        rx_stream_->Read(rx_active_.data_.get(), length);
+                        if (rx_active_.received_length_ != nullptr) {
+                            *rx_active_.received_length_ = length;
+                        }
+                        RecordLatency(stats_.rx_queue_latency, rx_active_.enqueue_time_, GetStatsTime());
+                        IoStatsCounters::Add(stats_.rx_bytes, length);
+                        IoStatsCounters::Add(stats_.rx_requests);
+                        STPP_IO_TRACE_EVENT(kRxCallbackBegin, trace_id_, rx_active_.id_, 0);
+                        if (rx_active_.callback_) {
+                            rx_active_.callback_(stpp::ErrorCode::OK);
+                        }
+                        STPP_IO_TRACE_EVENT(kRxCallbackEnd, trace_id_, rx_active_.id_, 0);
+                    }
+
+                    // 只在有新数据到来时调用新数据回调，剩余的旧数据不重复触发
+                    auto write_count  = rx_stream_->GetWriteCount();
+                    auto has_new_data = rx_stream_->GetSize() > 0 && write_count != rx_data_seen_;
+                    rx_data_seen_     = write_count;
+                    rx_sem_.unlock();
+
+                    // 同 DispatchTx()，占用期间可能有新数据或新请求到来
+                    {
+                        std::lock_guard lock(rx_queue_.lock);
+                        if (!rx_queue_.queue.IsEmpty() && GetStreamReadLength(rx_queue_.queue.Front()) != 0) {
+                            continue;
+                        }
+                    }
+
+                    if (has_new_data && rx_data_cb_) {
+                        rx_data_cb_(stpp::ErrorCode::OK);
+                    }
+                    return true;
+                }
+            }
+
+            /**
+             * @brief 流式接收时，环形缓冲区中的数据能否完成读请求 data_with_cb。必须持有 rx_queue_.lock
+             * @note ReadUntil 请求从上次查找的位置继续，逐字查找，每个字节只查找一次，临界区中的开销与新到的数据量成正比
+             *
+             * @return std::size_t 要读出的字节数，为 0 时数据还不够
+             */
+            std::size_t GetStreamReadLength(RxDataWithCallback &data_with_cb)
+            {
+                auto size = rx_stream_->GetSize();
+                if (!data_with_cb.is_until_) {
+                    return data_with_cb.length_ <= size ? data_with_cb.length_ : 0;
+                }
+
+                // 可读数据的开头移动过（借出视图后丢弃了数据，或者溢出），已查找的位置不再对应原来的数据
+                auto read_count = rx_stream_->GetReadCount();
+                if (data_with_cb.scan_base_ != read_count) {
+                    data_with_cb.scan_base_ = read_count;
+                    data_with_cb.scanned_   = 0;
+                }
+
+                auto end   = std::min(size, data_with_cb.length_);
+                auto index = rx_stream_->Find(data_with_cb.delimiter_, data_with_cb.scanned_, end);
+                if (index < end) {
+                    return index + 1;
+                }
+
+                data_with_cb.scanned_ = end;
+                return end == data_with_cb.length_ ? end : 0; // 最多读取的长度内没有分隔符，读满为止
+            }
+
+            /**
+             * @brief 让 driver_ 开始接收 rx_active_，并记录正在接收的请求 id 以便取消
+             *
+             */
+            bool StartRxTransfer()
+            {
+                std::lock_guard lock(transfer_lock_);
+                if (!this->driver_->AsyncRead(rx_active_.data_.get(), rx_active_.length_)) {
+                    return false;
+                }
+                rx_transfer_id_ = rx_active_.id_;
+                IoStatsCounters::Add(stats_.rx_transfers);
+                STPP_IO_TRACE_EVENT(kRxStart, trace_id_, rx_active_.id_, rx_active_.length_);
+                return true;
+            }
+
+            void OnRxComplete(stpp::ErrorCode ec)
+            {
+                auto transfer_id = rx_transfer_id_.exchange(0);
+                if (transfer_id == kInvalidRequestId) {
+                    return; // 同 OnTxComplete()
+                }
+                STPP_IO_TRACE_EVENT(kRxIrq, trace_id_, transfer_id, static_cast<uint32_t>(ec));
+                FinishRx(ec);
+            }
+
+            void FinishRx(stpp::ErrorCode ec)
+            {
+                if (ec == stpp::ErrorCode::OK) {
+                    IoStatsCounters::Add(stats_.rx_bytes, rx_active_.length_);
+                    IoStatsCounters::Add(stats_.rx_requests);
+                } else {
+                    IoStatsCounters::Add(stats_.rx_errors);
+                }
+                RecordLatency(stats_.rx_service_latency, rx_active_.start_time_, GetStatsTime());
+
+                STPP_IO_TRACE_EVENT(kRxCallbackBegin, trace_id_, rx_active_.id_, static_cast<uint32_t>(ec));
+                if (rx_active_.callback_) {
+                    rx_active_.callback_(ec);
+                }
+                STPP_IO_TRACE_EVENT(kRxCallbackEnd, trace_id_, rx_active_.id_, 0);
+                this->rx_sem_.unlock();
+                NotifySpinTask(kRxComplete);
+            }
+
+            /**
+             * @brief 从队列中取出 id 为 request_id 的请求
+             *
+             * @return true 找到并取出了请求
+             * @return false 请求不在队列中
+             */
+            template <typename Data_t>
+            static bool TakeQueued(stpp::CriticalSection &queue_lock, stpp::RingQueue<Data_t> &queue, RequestId_t request_id, Data_t &data)
+            {
+                std::lock_guard lock(queue_lock);
+                for (std::size_t i = 0; i < queue.GetSize(); i++) {
+                    if (queue[i].id_ == request_id) {
+                        data = std::move(queue[i]);
+                        queue.Erase(i);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * @brief 用 request 的回调函数提交请求。提交失败时直接完成 request
+             *
+             */
+            template <typename SubmitFunc_t>
+            bool Submit(IoRequest &request, bool is_read, SubmitFunc_t submit)
+            {
+                if (!submit(request.Prepare(this, is_read), &request.id_)) {
+                    request.Complete(stpp::ErrorCode::ERROR);
+                    return false;
+                }
+                return true;
+            }
+
+            static constexpr uint32_t kCancelRetryInterval = 1; // 超时后取消失败时重试的间隔，单位 ms
+
+            /**
+             * @brief 同步函数能否遵守 timeout：超时后必须能取消请求，确认 driver_ 不再访问调用者的数据才能返回
+             * @note 流式接收的读请求不经过 driver_ 传输，总能取消；其他请求可能正在传输，需要 driver_ 支持中止
+             *
+             */
+            bool IsTimeoutSupported(uint32_t timeout, bool is_read) const
+            {
+                if (timeout == std::numeric_limits<uint32_t>::max()) {
+                    return true;
+                }
+                return (is_read && rx_stream_ != nullptr) || driver_->IsAbortSupported();
+            }
+
+            /**
+             * @brief 等待同步函数提交的请求完成。超时则取消请求，并等到请求完成，确认 driver_ 不再访问调用者的数据
+             * @note 请求刚出队、driver_ 还没开始传输时取消会失败，合并发送中的写请求也不能取消。
+             *       这两种情况下请求很快就会开始传输或完成，所以每隔 kCancelRetryInterval 重试，直到取消成功或请求完成
+             *
+             */
+            static bool WaitOrCancel(IoRequest &request, uint32_t timeout)
+            {
+                if (!request.Wait(timeout)) {
+                    while (!request.Cancel()) {
+                        if (request.Wait(kCancelRetryInterval)) {
+                            break;
+                        }
+                    }
+                    request.Wait(); // 取消成功后等待中止完成，中止完成回调很快就会到来
+                }
+                return request.GetResult() == stpp::ErrorCode::OK;
+            }
+
+            /**
+             * @brief 现在能否写入 length 字节：内部缓冲区有足够空间，且 priority 的发送队列未满
+             *
+             */
+            bool IsWritable(std::size_t length, TxPriority priority)
+            {
+                {
+                    std::lock_guard lock(tx_queue_.lock);
+                    if (tx_queue_.GetLane(priority).IsFull()) {
+                        return false;
+                    }
+                }
+                return tx_pool_.CanAllocate(length);
+            }
+
+            bool AddWritableWaiter(TaskHandle_t task_handle)
+            {
+                std::lock_guard lock(writable_waiters_lock_);
+                for (auto &waiter : writable_waiters_) {
+                    if (waiter == nullptr) {
+                        waiter = task_handle;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void RemoveWritableWaiter(TaskHandle_t task_handle)
+            {
+                std::lock_guard lock(writable_waiters_lock_);
+                for (auto &waiter : writable_waiters_) {
+                    if (waiter == task_handle) {
+                        waiter = nullptr;
+                    }
+                }
+            }
+
+            void NotifyWritableWaiters()
+            {
+                TaskHandle_t waiters[kMaxWritableWaiters];
+                {
+                    std::lock_guard lock(writable_waiters_lock_);
+                    std::copy(std::begin(writable_waiters_), std::end(writable_waiters_), waiters);
+                }
+
+                for (auto waiter : waiters) {
+                    if (waiter != nullptr) {
+                        device_framework_internal::NotifyWake(waiter);
                     }
                 }
             }
+
+            /**
+             * @brief 发送队列中的数据达到高水位时调用水位回调函数
+             *
+             */
+            void CheckTxHighWatermark()
+            {
+                if (tx_high_watermark_ != 0 && tx_queued_size_ >= tx_high_watermark_ && !is_tx_above_high_.exchange(true) && tx_watermark_cb_) {
+                    tx_watermark_cb_(true);
+                }
+            }
+
+            /**
+             * @brief 发送队列中的数据减少了 length 字节，降到低水位时调用水位回调函数，并唤醒 WaitWritable() 中的线程
+             *
+             */
+            void ReleaseTxQueuedSize(std::size_t length)
+            {
+                auto size = tx_queued_size_.fetch_sub(length) - length;
+                if (size <= tx_low_watermark_ && is_tx_above_high_.exchange(false) && tx_watermark_cb_) {
+                    tx_watermark_cb_(false);
+                }
+                NotifyWritableWaiters();
+            }
+
+            void HandleEvents(uint32_t events)
+            {
+                STPP_IO_TRACE_EVENT(kDispatch, trace_id_, events, 0);
+
+                if (events & (kTxRequest | kTxComplete)) {
+                    DispatchTx();
+                }
+
+                if (events & (kRxRequest | kRxComplete)) {
+                    DispatchRx();
+                }
+            }
+
+            void Spin()
+            {
+                uint32_t events = kTxRequest | kRxRequest; // 防止在 Spin 之前有数据
+
+                while (true) {
+                    HandleEvents(events);
+                    xTaskNotifyWait(0, std::numeric_limits<uint32_t>::max(), &events, portMAX_DELAY);
+                }
+            }
         };
 
     }
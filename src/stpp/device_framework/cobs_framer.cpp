@@ -0,0 +1,76 @@
+#include "cobs_framer.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        void CobsFramer::StartReceiving(PacketCallbackFunc_t callback)
+        {
+            packet_cb_ = std::move(callback);
+            device_.SetRxDataCb([this](stpp::ErrorCode) {
+                OnRxData();
+            });
+        }
+
+        bool CobsFramer::AsyncSendPacket(const void *data, std::size_t length, device_framework_internal::CallbackFunc_t callback, RequestId_t *request_id, TxPriority priority)
+        {
+            auto buffer = device_.AllocateTxBuffer(stpp::GetCobsMaxEncodedLength(length) + 1);
+            if (!buffer) {
+                return false;
+            }
+
+            auto encoded_length              = stpp::CobsEncode(data, length, buffer.GetData());
+            buffer.GetData()[encoded_length] = 0; // 帧分隔符
+            buffer.SetLength(encoded_length + 1);
+            return device_.AsyncWrite(std::move(buffer), std::move(callback), request_id, priority);
+        }
+
+        CobsFramer::PacketBuffer CobsFramer::AllocatePacket(std::size_t max_length)
+        {
+            PacketBuffer packet;
+            auto overhead = stpp::GetCobsMaxEncodedLength(max_length) - max_length;
+
+            packet.buffer = device_.AllocateTxBuffer(overhead + max_length + 1);
+            if (!packet.buffer) {
+                return packet;
+            }
+
+            // 数据放在最坏情况的编码开销之后，编码结果从缓冲区开头写起，不会追上还没读取的数据
+            packet.data     = packet.buffer.GetData() + overhead;
+            packet.capacity = max_length;
+            return packet;
+        }
+
+        bool CobsFramer::AsyncSendPacket(PacketBuffer &&packet, std::size_t length, device_framework_internal::CallbackFunc_t callback, RequestId_t *request_id, TxPriority priority)
+        {
+            auto buffer = std::move(packet.buffer);
+            if (!buffer || length > packet.capacity) {
+                return false;
+            }
+
+            auto encoded_length              = stpp::CobsEncode(packet.data, length, buffer.GetData());
+            buffer.GetData()[encoded_length] = 0; // 帧分隔符
+            buffer.SetLength(encoded_length + 1);
+            return device_.AsyncWrite(std::move(buffer), std::move(callback), request_id, priority);
+        }
+
+        void CobsFramer::OnRxData()
+        {
+            RxView view;
+            if (!device_.AcquireRxView(view)) {
+                return;
+            }
+
+            auto on_packet = [this](const uint8_t *packet, std::size_t length) {
+                if (packet_cb_) {
+                    packet_cb_(packet, length);
+                }
+            };
+
+            // 解码器保存了不完整的包，所以视图中的数据可以全部归还
+            decoder_.Feed(view.first, view.first_length, on_packet);
+            decoder_.Feed(view.second, view.second_length, on_packet);
+            device_.ReleaseRxView(view.GetSize());
+        }
+    }
+}
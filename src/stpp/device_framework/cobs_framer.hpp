@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "byte_device.hpp"
+#include "tx_priority.hpp"
+#include "../cobs.hpp"
+#include "../inplace_function.hpp"
+#include "private_include/callback_func.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 在 ByteDevice 上用 COBS 收发数据包。每个包编码后以 0x00 结尾，接收端从任意位置开始都能重新同步
+         * @note 发送时直接编码到从设备发送缓冲池分配的缓冲区中，不需要单独的编码缓冲区，也没有第二次复制
+         * @note 接收时在环形缓冲区中原地解码，只能用于已开启流式接收的设备。开始接收后会占用设备的新数据回调
+         *
+         */
+        class CobsFramer
+        {
+        public:
+            using PacketCallbackFunc_t = stpp::InplaceFunction<void(const uint8_t *packet, std::size_t length)>;
+            using RequestId_t          = ByteDevice::RequestId_t;
+
+            /**
+             * @brief AllocatePacket() 分配的包缓冲区。把包的数据直接写到 data 中，再交给 AsyncSendPacket(PacketBuffer &&) 原地编码发送
+             *
+             */
+            struct PacketBuffer {
+                TxBuffer buffer;
+                uint8_t *data        = nullptr; // 包的数据从这里开始写，分配失败时为空
+                std::size_t capacity = 0;       // data 处可写的字节数
+            };
+
+            /**
+             * @param device 收发数据的设备
+             * @param max_packet_length 接收的包解码后的最大长度，单位字节。更长的包被丢弃
+             */
+            CobsFramer(ByteDevice &device, std::size_t max_packet_length)
+                : device_(device), decoder_(max_packet_length) {};
+
+            CobsFramer(CobsFramer &&)                 = delete;
+            CobsFramer(const CobsFramer &)            = delete;
+            CobsFramer &operator=(CobsFramer &&)      = delete;
+            CobsFramer &operator=(const CobsFramer &) = delete;
+
+            /**
+             * @brief 开始接收。每收到一个完整的包调用一次 callback，包的数据只在回调期间有效
+             * @note 回调在设备的新数据回调中执行，执行上下文取决于设备的打开方式
+             *
+             */
+            void StartReceiving(PacketCallbackFunc_t callback);
+
+            /**
+             * @brief 编码并发送一个包，不会阻塞。可以在中断上下文中调用
+             *
+             * @param data 包的数据，调用返回后即可释放
+             * @param length 包的长度，单位字节
+             * @param request_id 不为空时保存请求的 id，可用于取消请求
+             * @param priority 发送优先级
+             * @return true 成功
+             * @return false 内存不足或队列已满
+             */
+            bool AsyncSendPacket(const void *data, std::size_t length, device_framework_internal::CallbackFunc_t callback = device_framework_internal::CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal);
+
+            /**
+             * @brief 从设备的发送缓冲池分配一个最长 max_length 字节的包缓冲区。可以在中断上下文中调用
+             * @note 缓冲区前部预留了 COBS 编码的开销，编码时数据向前移动，不需要第二个缓冲区
+             *
+             * @return PacketBuffer 内存不足时 data 为空
+             */
+            PacketBuffer AllocatePacket(std::size_t max_length);
+
+            /**
+             * @brief 原地编码并发送 AllocatePacket() 分配的包，不会阻塞。可以在中断上下文中调用
+             *
+             * @param packet 已写好数据的包缓冲区，无论成功与否都会被释放
+             * @param length 包的长度，单位字节，不能超过 packet.capacity
+             * @return true 成功
+             * @return false 长度超出缓冲区或队列已满
+             */
+            bool AsyncSendPacket(PacketBuffer &&packet, std::size_t length, device_framework_internal::CallbackFunc_t callback = device_framework_internal::CallbackFunc_t(), RequestId_t *request_id = nullptr, TxPriority priority = TxPriority::kNormal);
+
+            /**
+             * @brief 因超长或格式错误而丢弃的接收包数
+             *
+             */
+            uint32_t GetRxErrorCount() const
+            {
+                return decoder_.GetErrorCount();
+            }
+
+        private:
+            ByteDevice &device_;
+            stpp::CobsDecoder decoder_;
+            PacketCallbackFunc_t packet_cb_;
+
+            void OnRxData();
+        };
+    }
+}
@@ -0,0 +1,134 @@
+#include "coro.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include "private_include/task_wake.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        namespace coro
+        {
+            using namespace device_framework_internal;
+
+            FramePool::FramePool(std::size_t block_size, std::size_t block_count)
+                : block_count_(block_count)
+            {
+                // 每块都要能放下空闲链表的指针，并按最大对齐要求对齐
+                constexpr auto kAlign = alignof(std::max_align_t);
+                block_size_           = (std::max(block_size, sizeof(FreeBlock)) + kAlign - 1) / kAlign * kAlign;
+
+                storage_ = new (std::align_val_t(kAlign)) uint8_t[block_size_ * block_count_];
+                for (std::size_t i = block_count_; i > 0; i--) {
+                    auto block  = reinterpret_cast<FreeBlock *>(storage_ + (i - 1) * block_size_);
+                    block->next = free_list_;
+                    free_list_  = block;
+                }
+            }
+
+            FramePool::~FramePool()
+            {
+                if (installed_ == this) {
+                    installed_ = nullptr;
+                }
+                operator delete[](storage_, std::align_val_t(alignof(std::max_align_t)));
+            }
+
+            void *FramePool::Allocate(std::size_t size)
+            {
+                if (size > block_size_) {
+                    return nullptr;
+                }
+
+                std::lock_guard lock(lock_);
+                auto block = free_list_;
+                if (block != nullptr) {
+                    free_list_ = block->next;
+                    used_count_++;
+                }
+                return block;
+            }
+
+            void FramePool::Free(void *block)
+            {
+                std::lock_guard lock(lock_);
+                auto free_block  = static_cast<FreeBlock *>(block);
+                free_block->next = free_list_;
+                free_list_       = free_block;
+                used_count_--;
+            }
+
+            bool Executor::Spawn(Task<void> task)
+            {
+                if (!task) {
+                    return false;
+                }
+
+                auto handle                   = task.Release();
+                handle.promise().executor_    = this;
+                handle.promise().is_detached_ = true;
+
+                if (!Post(handle)) {
+                    handle.destroy();
+                    return false;
+                }
+                return true;
+            }
+
+            void Executor::Start(const char *const thread_name, uint32_t stack_depth, UBaseType_t thread_priority)
+            {
+                auto result = xTaskCreate(TaskEntry, thread_name, stack_depth, this, thread_priority, &task_handle_);
+
+                if (result != pdPASS) {
+                    throw std::runtime_error("Failed to create coroutine executor task");
+                }
+            }
+
+            bool Executor::Post(std::coroutine_handle<> handle)
+            {
+                {
+                    std::lock_guard lock(lock_);
+                    if (!ready_.PushBack(handle)) {
+                        return false;
+                    }
+                }
+
+                if (task_handle_ != nullptr) {
+                    NotifyWake(task_handle_); // 还没有 Start() 时，Spin 开始时会处理就绪队列
+                }
+                return true;
+            }
+
+            void Executor::TaskEntry(void *argument)
+            {
+                static_cast<Executor *>(argument)->Spin();
+                vTaskDelete(nullptr);
+            }
+
+            void Executor::Spin()
+            {
+                while (true) {
+                    std::coroutine_handle<> handle;
+                    bool has_ready;
+                    {
+                        std::lock_guard lock(lock_);
+                        has_ready = ready_.PopFront(handle);
+                    }
+
+                    if (!has_ready) {
+                        WaitWake(portMAX_DELAY);
+                        continue;
+                    }
+
+                    handle.resume();
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,432 @@
+#pragma once
+
+/**
+ * @file coro.hpp
+ * @brief ByteDevice 的 C++20 协程接口。工程以 C++17 编译时整个文件为空，切换到 C++20 后才可用
+ *
+ */
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "byte_device.hpp"
+#include "../error_code.hpp"
+#include "../freertos_lock.hpp"
+#include "../ring_queue.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        namespace coro
+        {
+            class Executor;
+
+            /**
+             * @brief 协程帧的内存池。块大小和块数在构造时确定，全部内存在构造时一次分配，之后不再使用堆
+             * @note 协程帧从 Install() 的内存池中分配。帧大于块大小或内存池已满时协程创建失败，不会退回到堆
+             *
+             */
+            class FramePool
+            {
+            public:
+                /**
+                 * @param block_size 每块的大小，单位字节，必须不小于最大的协程帧
+                 * @param block_count 块数，即最多同时存在的协程数
+                 */
+                FramePool(std::size_t block_size, std::size_t block_count);
+
+                FramePool(FramePool &&)                 = delete;
+                FramePool(const FramePool &)            = delete;
+                FramePool &operator=(FramePool &&)      = delete;
+                FramePool &operator=(const FramePool &) = delete;
+
+                ~FramePool();
+
+                /**
+                 * @brief 之后创建的协程都从这个内存池分配帧。必须在创建任何协程之前调用
+                 *
+                 */
+                void Install()
+                {
+                    installed_ = this;
+                }
+
+                static FramePool *GetInstalled()
+                {
+                    return installed_;
+                }
+
+                /**
+                 * @brief 分配一块。可以在中断上下文中调用
+                 *
+                 * @return void* 失败返回 nullptr
+                 */
+                void *Allocate(std::size_t size);
+
+                void Free(void *block);
+
+                std::size_t GetBlockSize() const
+                {
+                    return block_size_;
+                }
+
+                std::size_t GetBlockCount() const
+                {
+                    return block_count_;
+                }
+
+                /**
+                 * @brief 正在使用的块数
+                 *
+                 */
+                std::size_t GetUsedCount() const
+                {
+                    return used_count_;
+                }
+
+            private:
+                struct FreeBlock {
+                    FreeBlock *next;
+                };
+
+                static inline FramePool *installed_ = nullptr;
+
+                uint8_t *storage_;
+                std::size_t block_size_;
+                std::size_t block_count_;
+                std::size_t used_count_ = 0;
+                FreeBlock *free_list_   = nullptr;
+                stpp::CriticalSection lock_;
+            };
+
+            namespace coro_internal
+            {
+                /**
+                 * @brief 所有协程的 promise 的公共部分：帧的分配，以及所属的执行器和等待者
+                 *
+                 */
+                struct PromiseBase {
+                    Executor *executor_                   = nullptr;
+                    std::coroutine_handle<> continuation_ = nullptr; // co_await 这个协程的协程，完成时恢复它
+                    bool is_detached_                     = false;   // 由 Executor::Spawn() 启动，完成时自行销毁
+                    std::exception_ptr exception_         = nullptr;
+
+                    static void *operator new(std::size_t size) noexcept
+                    {
+                        auto pool = FramePool::GetInstalled();
+                        return pool == nullptr ? nullptr : pool->Allocate(size);
+                    }
+
+                    static void operator delete(void *ptr) noexcept
+                    {
+                        FramePool::GetInstalled()->Free(ptr);
+                    }
+
+                    std::suspend_always initial_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    struct FinalAwaiter {
+                        bool await_ready() noexcept
+                        {
+                            return false;
+                        }
+
+                        template <typename Promise_t>
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_t> handle) noexcept
+                        {
+                            auto &promise = handle.promise();
+                            if (promise.continuation_) {
+                                return promise.continuation_;
+                            }
+
+                            if (promise.is_detached_) {
+                                if (promise.exception_) {
+                                    std::terminate(); // 与 std::thread 相同，根协程不能有未捕获的异常
+                                }
+                                handle.destroy();
+                            }
+                            return std::noop_coroutine();
+                        }
+
+                        void await_resume() noexcept {}
+                    };
+
+                    FinalAwaiter final_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    void unhandled_exception() noexcept
+                    {
+                        exception_ = std::current_exception();
+                    }
+                };
+
+                template <typename T>
+                struct Promise : PromiseBase {
+                    T value_{};
+
+                    template <typename U>
+                    void return_value(U &&value)
+                    {
+                        value_ = std::forward<U>(value);
+                    }
+
+                    T TakeResult()
+                    {
+                        if (exception_) {
+                            std::rethrow_exception(exception_);
+                        }
+                        return std::move(value_);
+                    }
+                };
+
+                template <>
+                struct Promise<void> : PromiseBase {
+                    void return_void() noexcept {}
+
+                    void TakeResult()
+                    {
+                        if (exception_) {
+                            std::rethrow_exception(exception_);
+                        }
+                    }
+                };
+            }
+
+            /**
+             * @brief 协程的返回类型。协程创建后不会立即运行，直到被 co_await 或交给 Executor::Spawn()
+             * @note 帧从 FramePool 分配。分配失败时 Task 为空，co_await 空的 Task 会抛出 std::bad_alloc
+             *
+             */
+            template <typename T = void>
+            class Task
+            {
+            public:
+                struct promise_type : coro_internal::Promise<T> {
+                    Task get_return_object() noexcept
+                    {
+                        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+                    }
+
+                    static Task get_return_object_on_allocation_failure() noexcept
+                    {
+                        return Task();
+                    }
+                };
+
+                using Handle_t = std::coroutine_handle<promise_type>;
+
+                Task() = default;
+
+                Task(Task &&other) noexcept
+                    : handle_(std::exchange(other.handle_, nullptr)) {};
+
+                Task &operator=(Task &&other) noexcept
+                {
+                    if (this != &other) {
+                        if (handle_) handle_.destroy();
+                        handle_ = std::exchange(other.handle_, nullptr);
+                    }
+                    return *this;
+                }
+
+                Task(const Task &)            = delete;
+                Task &operator=(const Task &) = delete;
+
+                ~Task()
+                {
+                    if (handle_) handle_.destroy();
+                }
+
+                explicit operator bool() const
+                {
+                    return static_cast<bool>(handle_);
+                }
+
+                struct Awaiter {
+                    Handle_t handle;
+
+                    bool await_ready() const noexcept
+                    {
+                        return !handle;
+                    }
+
+                    template <typename Promise_t>
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_t> caller) noexcept
+                    {
+                        handle.promise().executor_     = caller.promise().executor_;
+                        handle.promise().continuation_ = caller;
+                        return handle;
+                    }
+
+                    T await_resume()
+                    {
+                        if (!handle) {
+                            throw std::bad_alloc();
+                        }
+                        return handle.promise().TakeResult();
+                    }
+                };
+
+                Awaiter operator co_await() && noexcept
+                {
+                    return Awaiter{handle_};
+                }
+
+            private:
+                friend class Executor;
+
+                Handle_t handle_ = nullptr;
+
+                explicit Task(Handle_t handle)
+                    : handle_(handle) {};
+
+                Handle_t Release()
+                {
+                    return std::exchange(handle_, nullptr);
+                }
+            };
+
+            /**
+             * @brief 协程执行器。所有协程都在一个 FreeRTOS 线程中运行，I/O 完成时（可能在中断中）把协程放回就绪队列
+             * @note 就绪队列的容量必须不小于同时存在的协程数，通常等于 FramePool 的块数
+             *
+             */
+            class Executor
+            {
+            public:
+                Executor(std::size_t capacity)
+                    : ready_(capacity) {};
+
+                Executor(Executor &&)                 = delete;
+                Executor(const Executor &)            = delete;
+                Executor &operator=(Executor &&)      = delete;
+                Executor &operator=(const Executor &) = delete;
+
+                /**
+                 * @brief 启动一个根协程，协程完成后自动销毁。可以在 Start() 之前调用
+                 *
+                 * @return true 成功
+                 * @return false task 为空（帧分配失败）或就绪队列已满
+                 */
+                bool Spawn(Task<void> task);
+
+                /**
+                 * @brief 启动执行线程
+                 *
+                 * @param thread_name 线程名称
+                 * @param stack_depth 线程栈大小，单位字。所有协程共用这个栈，只需要容纳最深的一次恢复
+                 * @param thread_priority 线程优先级
+                 */
+                void Start(const char *const thread_name = "CoroExecutor", uint32_t stack_depth = 512, UBaseType_t thread_priority = 3);
+
+                /**
+                 * @brief 把协程放入就绪队列，由执行线程恢复。可以在中断上下文中调用
+                 *
+                 */
+                bool Post(std::coroutine_handle<> handle);
+
+            private:
+                stpp::CriticalSection lock_;
+                stpp::RingQueue<std::coroutine_handle<>> ready_;
+                TaskHandle_t task_handle_ = nullptr;
+
+                static void TaskEntry(void *argument);
+                void Spin();
+            };
+
+            /**
+             * @brief ByteDevice 读写的 awaitable，co_await 的结果是请求的 stpp::ErrorCode
+             * @note 使用不复制数据的接口，数据在协程帧或调用者手中，请求完成之前一直有效
+             *
+             */
+            class IoAwaitable
+            {
+            public:
+                enum class Kind : uint8_t {
+                    kRead,
+                    kWrite,
+                };
+
+                IoAwaitable(ByteDevice &device, Kind kind, void *data, std::size_t length, TxPriority priority)
+                    : device_(device), data_(data), length_(length), kind_(kind), priority_(priority) {};
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template <typename Promise_t>
+                bool await_suspend(std::coroutine_handle<Promise_t> caller)
+                {
+                    handle_   = caller;
+                    executor_ = caller.promise().executor_;
+                    return Submit();
+                }
+
+                stpp::ErrorCode await_resume() const noexcept
+                {
+                    return result_;
+                }
+
+            private:
+                ByteDevice &device_;
+                void *data_;
+                std::size_t length_;
+                Kind kind_;
+                TxPriority priority_;
+                stpp::ErrorCode result_         = stpp::ErrorCode::ERROR;
+                std::coroutine_handle<> handle_ = nullptr;
+                Executor *executor_             = nullptr;
+
+                /**
+                 * @brief 提交请求
+                 *
+                 * @return true 已提交，协程挂起直到请求完成
+                 * @return false 提交失败，协程立即继续，结果为 ErrorCode::ERROR
+                 */
+                bool Submit()
+                {
+                    auto callback = [this](stpp::ErrorCode ec) {
+                        result_ = ec;
+                        executor_->Post(handle_);
+                    };
+
+                    if (kind_ == Kind::kRead) {
+                        return device_.AsyncRead(data_, length_, callback);
+                    }
+                    return device_.AsyncWriteNoCopy(data_, length_, callback, nullptr, priority_);
+                }
+            };
+        }
+
+        inline coro::IoAwaitable ByteDevice::Read(void *data, std::size_t length)
+        {
+            return coro::IoAwaitable(*this, coro::IoAwaitable::Kind::kRead, data, length, TxPriority::kNormal);
+        }
+
+        inline coro::IoAwaitable ByteDevice::Write(const void *data, std::size_t length, TxPriority priority)
+        {
+            return coro::IoAwaitable(*this, coro::IoAwaitable::Kind::kWrite, const_cast<void *>(data), length, priority);
+        }
+
+        inline coro::IoAwaitable ByteDevice::Write(const std::string_view str, TxPriority priority)
+        {
+            return Write(str.data(), str.length(), priority);
+        }
+    }
+}
+
+#endif
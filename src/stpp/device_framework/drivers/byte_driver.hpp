@@ -1,8 +1,8 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
 #include "../../error_code.hpp"
+#include "../../inplace_function.hpp"
 
 namespace stpp
 {
@@ -10,12 +10,14 @@ namespace stpp
     {
         class ByteDriver
         {
-            using CallbackFunc_t = std::function<void(stpp::ErrorCode)>;
+            using CallbackFunc_t       = stpp::InplaceFunction<void(stpp::ErrorCode)>;
+            using StreamCallbackFunc_t = stpp::InplaceFunction<void(std::size_t write_pos, bool is_restarted)>;
 
         public:
             ByteDriver()                   = default;
             ByteDriver(const ByteDriver &) = delete;
             ByteDriver(ByteDriver &&)      = default;
+            virtual ~ByteDriver()          = default;
 
             virtual bool AsyncRead(uint8_t *buffer, std::size_t length)        = 0;
             virtual bool AsyncWrite(const uint8_t *buffer, std::size_t length) = 0;
@@ -23,6 +25,96 @@ namespace stpp
             virtual void HardwareTxCpltCallback() = 0;
             virtual void HardwareRxCpltCallback() = 0;
 
+            /**
+             * @brief 是否支持 AbortRead()/AbortWrite()。不支持时同步读写无法在超时后取消正在进行的传输
+             *
+             */
+            virtual bool IsAbortSupported() const
+            {
+                return false;
+            }
+
+            /**
+             * @brief 中止正在进行的读取。中止完成后以 ErrorCode::CANCELLED 调用读取完成回调函数
+             * @note 不支持中止的驱动返回 false
+             *
+             */
+            virtual bool AbortRead()
+            {
+                return false;
+            }
+
+            /**
+             * @brief 中止正在进行的写入。中止完成后以 ErrorCode::CANCELLED 调用写入完成回调函数
+             * @note 不支持中止的驱动返回 false
+             *
+             */
+            virtual bool AbortWrite()
+            {
+                return false;
+            }
+
+            /**
+             * @brief 读取中止完成的中断中调用
+             *
+             */
+            virtual void HardwareRxAbortCallback()
+            {
+                if (read_cplt_cb_) {
+                    read_cplt_cb_(ErrorCode::CANCELLED);
+                }
+            }
+
+            /**
+             * @brief 写入中止完成的中断中调用
+             *
+             */
+            virtual void HardwareTxAbortCallback()
+            {
+                if (write_cplt_cb_) {
+                    write_cplt_cb_(ErrorCode::CANCELLED);
+                }
+            }
+
+            /**
+             * @brief 开始流式接收：硬件持续不断地把收到的数据循环写入 buffer，每当有新数据写入时调用流式接收回调函数
+             * @note 不支持流式接收的驱动返回 false
+             *
+             * @param buffer 环形缓冲区
+             * @param length 环形缓冲区大小，单位字节
+             */
+            virtual bool StartStreamRead(uint8_t *buffer, std::size_t length)
+            {
+                (void)buffer;
+                (void)length;
+                return false;
+            }
+
+            /**
+             * @brief 流式接收时，硬件报告新数据的中断中调用
+             *
+             * @param write_pos 硬件下一个要写入的位置
+             */
+            virtual void HardwareRxEventCallback(std::size_t write_pos)
+            {
+                (void)write_pos;
+            }
+
+            /**
+             * @brief 硬件出错的中断中调用
+             *
+             */
+            virtual void HardwareErrorCallback() {}
+
+            /**
+             * @brief 设置流式接收回调函数。write_pos 为硬件下一个要写入的位置；is_restarted 为 true 表示出错后重新开始了接收，write_pos 回到 0
+             *
+             */
+            void SetStreamRxCb(StreamCallbackFunc_t cb)
+            {
+                stream_rx_cb_ = std::move(cb);
+            }
+
             void SetReadCpltCb(CallbackFunc_t cb)
             {
                 read_cplt_cb_ = std::move(cb);
@@ -36,6 +128,7 @@ namespace stpp
         protected:
             CallbackFunc_t read_cplt_cb_;
             CallbackFunc_t write_cplt_cb_;
+            StreamCallbackFunc_t stream_rx_cb_;
         };
     }
 }
\ No newline at end of file
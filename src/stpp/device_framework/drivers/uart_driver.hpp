@@ -75,6 +75,69 @@ namespace stpp
                 return result == HAL_OK;
             }
 
+            virtual bool IsAbortSupported() const override
+            {
+                return true;
+            }
+
+            /**
+             * @brief 中止读取，完成后 HAL 调用 HAL_UART_AbortReceiveCpltCallback()
+             *
+             */
+            virtual bool AbortRead() override
+            {
+                return HAL_UART_AbortReceive_IT(huart_) == HAL_OK;
+            }
+
+            /**
+             * @brief 中止写入，完成后 HAL 调用 HAL_UART_AbortTransmitCpltCallback()
+             *
+             */
+            virtual bool AbortWrite() override
+            {
+                return HAL_UART_AbortTransmit_IT(huart_) == HAL_OK;
+            }
+
+            /**
+             * @brief 以循环模式的 DMA 开始流式接收。半满、全满和空闲线路（IDLE）事件都会报告新的写入位置
+             * @note 需要在 CubeMX 中打开接收 DMA；DMA 会在这里被切换为循环模式，之后不能再使用 AsyncRead
+             *
+             */
+            virtual bool StartStreamRead(uint8_t *buffer, std::size_t length) override
+            {
+                assert(buffer != nullptr);
+                assert(length <= std::numeric_limits<uint16_t>::max());
+                assert(huart_->hdmarx != nullptr); // 流式接收需要接收 DMA
+
+                huart_->hdmarx->Init.Mode = DMA_CIRCULAR;
+                if (HAL_DMA_Init(huart_->hdmarx) != HAL_OK) {
+                    return false;
+                }
+
+                stream_buffer_ = buffer;
+                stream_length_ = length;
+                return HAL_UARTEx_ReceiveToIdle_DMA(huart_, buffer, length) == HAL_OK;
+            }
+
+            virtual void HardwareRxEventCallback(std::size_t write_pos) override
+            {
+                if (stream_rx_cb_) {
+                    stream_rx_cb_(write_pos == stream_length_ ? 0 : write_pos, false);
+                }
+            }
+
+            virtual void HardwareErrorCallback() override
+            {
+                if (stream_buffer_ == nullptr) {
+                    return;
+                }
+
+                // HAL 在出错（如溢出）时会停止 DMA 接收，流式接收需要重新开始
+                if (HAL_UARTEx_ReceiveToIdle_DMA(huart_, stream_buffer_, stream_length_) == HAL_OK && stream_rx_cb_) {
+                    stream_rx_cb_(0, true);
+                }
+            }
+
             virtual void HardwareRxCpltCallback() override
             {
                 if (read_cplt_cb_) {
@@ -90,6 +153,9 @@ namespace stpp
             }
 
         protected:
+            uint8_t *stream_buffer_    = nullptr; // 流式接收的环形缓冲区，为空时没有在流式接收
+            std::size_t stream_length_ = 0;
+
             bool IsAddressValidForDma(const void *addr)
             {
                 size_t addr_int = reinterpret_cast<size_t>(addr);
@@ -0,0 +1,90 @@
+#include "io_request.hpp"
+#include "byte_device.hpp"
+#include "private_include/task_wake.hpp"
+#include "../freertos_delay_ms.h"
+#include "../in_handle_mode.h"
+
+namespace stpp
+{
+    namespace device
+    {
+        using namespace device_framework_internal;
+
+        device_framework_internal::CallbackFunc_t IoRequest::Prepare(ByteDevice *device, bool is_read)
+        {
+            device_      = device;
+            is_read_     = is_read;
+            id_          = ByteDevice::kInvalidRequestId;
+            task_handle_ = InHandlerMode() ? nullptr : xTaskGetCurrentTaskHandle();
+            result_      = stpp::ErrorCode::ERROR;
+            is_done_.store(false, std::memory_order_relaxed);
+
+            return [this](stpp::ErrorCode ec) {
+                Complete(ec);
+            };
+        }
+
+        void IoRequest::Complete(stpp::ErrorCode ec)
+        {
+            // 置位 is_done_ 之后等待者可能立刻返回并销毁句柄，所以先取出要唤醒的线程
+            auto task_handle = task_handle_;
+            result_          = ec;
+            is_done_.store(true, std::memory_order_release);
+
+            if (task_handle != nullptr) {
+                NotifyWake(task_handle);
+            }
+        }
+
+        bool IoRequest::Cancel()
+        {
+            if (device_ == nullptr || IsDone()) {
+                return false;
+            }
+            return is_read_ ? device_->CancelRead(id_) : device_->CancelWrite(id_);
+        }
+
+        bool IoRequest::Wait(uint32_t timeout)
+        {
+            IoRequest *requests[] = {this};
+            return WaitAll(requests, 1, timeout);
+        }
+
+        bool IoRequest::WaitAll(IoRequest *const *requests, std::size_t count, uint32_t timeout)
+        {
+            auto start = xTaskGetTickCount();
+            auto ticks = FreeRtosMsToTick(timeout);
+
+            for (std::size_t i = 0; i < count; i++) {
+                while (!requests[i]->IsDone()) {
+                    auto remaining = GetRemainingTicks(start, ticks);
+                    if (remaining == 0) {
+                        return false;
+                    }
+                    WaitWake(remaining);
+                }
+            }
+            return true;
+        }
+
+        int IoRequest::WaitAny(IoRequest *const *requests, std::size_t count, uint32_t timeout)
+        {
+            auto start = xTaskGetTickCount();
+            auto ticks = FreeRtosMsToTick(timeout);
+
+            while (true) {
+                for (std::size_t i = 0; i < count; i++) {
+                    if (requests[i]->IsDone()) {
+                        return static_cast<int>(i);
+                    }
+                }
+
+                auto remaining = GetRemainingTicks(start, ticks);
+                if (remaining == 0) {
+                    return -1;
+                }
+                WaitWake(remaining);
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "../error_code.hpp"
+#include "private_include/callback_func.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        class ByteDevice;
+
+        /**
+         * @brief 异步读写请求的完成句柄。可以查询是否完成、带超时等待，或与其他句柄（可以属于不同设备）一起等待
+         * @note 句柄由调用者持有（通常在栈上），请求完成前不能销毁。不需要回调函数，不分配内存
+         * @note 只有提交请求的线程能等待。等待时只使用线程通知值的最高位，不影响其他位
+         *
+         */
+        class IoRequest
+        {
+        public:
+            IoRequest()                             = default;
+            IoRequest(IoRequest &&)                 = delete;
+            IoRequest(const IoRequest &)            = delete;
+            IoRequest &operator=(IoRequest &&)      = delete;
+            IoRequest &operator=(const IoRequest &) = delete;
+
+            /**
+             * @brief 请求是否已完成（成功、失败或被取消）。可以在中断上下文中调用
+             *
+             */
+            bool IsDone() const
+            {
+                return is_done_.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief 请求的结果。请求完成之前为 ErrorCode::ERROR
+             *
+             */
+            stpp::ErrorCode GetResult() const
+            {
+                return result_;
+            }
+
+            /**
+             * @brief 阻塞直到请求完成。不能在中断上下文中调用
+             *
+             * @param timeout 超时时间，单位 ms
+             * @return true 请求已完成
+             * @return false 超时
+             */
+            bool Wait(uint32_t timeout = std::numeric_limits<uint32_t>::max());
+
+            /**
+             * @brief 取消请求，见 ByteDevice::CancelRead()/CancelWrite()
+             *
+             */
+            bool Cancel();
+
+            /**
+             * @brief 阻塞直到所有请求都完成。不能在中断上下文中调用
+             *
+             * @return true 所有请求都已完成
+             * @return false 超时
+             */
+            static bool WaitAll(IoRequest *const *requests, std::size_t count, uint32_t timeout = std::numeric_limits<uint32_t>::max());
+
+            static bool WaitAll(std::initializer_list<IoRequest *> requests, uint32_t timeout = std::numeric_limits<uint32_t>::max())
+            {
+                return WaitAll(requests.begin(), requests.size(), timeout);
+            }
+
+            /**
+             * @brief 阻塞直到任意一个请求完成。不能在中断上下文中调用
+             *
+             * @return int 已完成的请求的下标，有多个时返回最小的下标；超时返回 -1
+             */
+            static int WaitAny(IoRequest *const *requests, std::size_t count, uint32_t timeout = std::numeric_limits<uint32_t>::max());
+
+            static int WaitAny(std::initializer_list<IoRequest *> requests, uint32_t timeout = std::numeric_limits<uint32_t>::max())
+            {
+                return WaitAny(requests.begin(), requests.size(), timeout);
+            }
+
+        private:
+            friend class ByteDevice;
+
+            ByteDevice *device_       = nullptr;
+            bool is_read_             = false;
+            uint32_t id_              = 0;
+            TaskHandle_t task_handle_ = nullptr; // 提交请求的线程，请求完成时唤醒
+            stpp::ErrorCode result_   = stpp::ErrorCode::ERROR;
+            std::atomic<bool> is_done_{false};
+
+            /**
+             * @brief 提交请求之前由 ByteDevice 调用，重置状态并生成回调函数
+             *
+             */
+            device_framework_internal::CallbackFunc_t Prepare(ByteDevice *device, bool is_read);
+
+            /**
+             * @brief 请求完成时调用。可以在中断上下文中调用
+             *
+             */
+            void Complete(stpp::ErrorCode ec);
+        };
+    }
+}
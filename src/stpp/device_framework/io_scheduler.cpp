@@ -0,0 +1,87 @@
+#include "io_scheduler.hpp"
+#include "byte_device.hpp"
+#include "../in_handle_mode.h"
+#include <limits>
+#include <stdexcept>
+
+namespace stpp
+{
+    namespace device
+    {
+        void IoScheduler::Register(ByteDevice &device, uint8_t priority)
+        {
+            if (device_count_ >= kMaxDevices) {
+                throw std::length_error("Too many devices registered to IoScheduler");
+            }
+
+            auto slot               = device_count_++;
+            devices_[slot].device   = &device;
+            devices_[slot].priority = priority;
+            device.AttachScheduler(this, slot);
+        }
+
+        void IoScheduler::Start(const char *const thread_name, uint32_t stack_depth, UBaseType_t thread_priority)
+        {
+            auto result = xTaskCreate(TaskEntry, thread_name, stack_depth, this, thread_priority, &task_handle_);
+
+            if (result != pdPASS) {
+                throw std::runtime_error("Failed to create IoScheduler task");
+            }
+        }
+
+        void IoScheduler::Notify(std::size_t slot)
+        {
+            if (task_handle_ == nullptr) {
+                return; // 还没有 Start()，Spin 开始时会处理所有设备
+            }
+
+            if (InHandlerMode()) {
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+                xTaskNotifyFromISR(task_handle_, 1u << slot, eSetBits, &xHigherPriorityTaskWoken);
+                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            } else {
+                xTaskNotify(task_handle_, 1u << slot, eSetBits);
+            }
+        }
+
+        std::size_t IoScheduler::PickNext(uint32_t ready_mask) const
+        {
+            std::size_t best = kMaxDevices;
+
+            for (std::size_t i = 0; i < device_count_; i++) {
+                auto slot = (rr_cursor_ + i) % device_count_;
+                if ((ready_mask & (1u << slot)) == 0) continue;
+
+                if (best == kMaxDevices || devices_[slot].priority > devices_[best].priority) {
+                    best = slot;
+                }
+            }
+
+            return best;
+        }
+
+        void IoScheduler::TaskEntry(void *argument)
+        {
+            static_cast<IoScheduler *>(argument)->Spin();
+            vTaskDelete(nullptr);
+        }
+
+        void IoScheduler::Spin()
+        {
+            // 防止在 Spin 之前有数据
+            uint32_t ready_mask = device_count_ >= 32 ? std::numeric_limits<uint32_t>::max() : (1u << device_count_) - 1;
+
+            while (true) {
+                while (ready_mask != 0) {
+                    auto slot = PickNext(ready_mask);
+                    ready_mask &= ~(1u << slot);
+                    rr_cursor_ = slot + 1;
+
+                    devices_[slot].device->HandleSchedulerEvents();
+                }
+
+                xTaskNotifyWait(0, std::numeric_limits<uint32_t>::max(), &ready_mask, portMAX_DELAY);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <FreeRTOS.h>
+#include <task.h>
+
+namespace stpp
+{
+    namespace device
+    {
+        class ByteDevice;
+
+        /**
+         * @brief I/O 调度器。用一个线程为多个 ByteDevice 调度读写请求，代替每个设备各自的守护线程
+         * @note 每个设备占用线程通知值中的一位，所以最多支持 kMaxDevices 个设备
+         *
+         */
+        class IoScheduler
+        {
+        public:
+            static constexpr std::size_t kMaxDevices = 32;
+
+            IoScheduler()                               = default;
+            IoScheduler(IoScheduler &&)                 = delete;
+            IoScheduler(const IoScheduler &)            = delete;
+            IoScheduler &operator=(IoScheduler &&)      = delete;
+            IoScheduler &operator=(const IoScheduler &) = delete;
+
+            /**
+             * @brief 注册一个设备，注册后设备的请求由调度器调度。代替该设备的 Open()
+             * @note 必须在 Start() 之前调用
+             *
+             * @param device 要注册的设备
+             * @param priority 优先级，数字越大越先处理。相同优先级的设备轮流优先处理
+             */
+            void Register(ByteDevice &device, uint8_t priority = 0);
+
+            /**
+             * @brief 启动调度线程
+             *
+             * @param thread_name 线程名称
+             * @param stack_depth 线程栈大小，单位字
+             * @param thread_priority 线程优先级
+             */
+            void Start(const char *const thread_name = "IoScheduler", uint32_t stack_depth = 512, UBaseType_t thread_priority = 3);
+
+            /**
+             * @brief 通知调度线程 slot 号设备有事件需要处理。可以在中断上下文中调用
+             *
+             */
+            void Notify(std::size_t slot);
+
+            std::size_t GetDeviceCount() const
+            {
+                return device_count_;
+            }
+
+        private:
+            struct Entry {
+                ByteDevice *device;
+                uint8_t priority;
+            };
+
+            Entry devices_[kMaxDevices] = {};
+            std::size_t device_count_   = 0;
+            std::size_t rr_cursor_      = 0; // 相同优先级时，从这个位置开始优先处理
+            TaskHandle_t task_handle_   = nullptr;
+
+            /**
+             * @brief 从 ready_mask 中选出下一个要处理的设备：优先级最高，相同优先级时轮流
+             *
+             */
+            std::size_t PickNext(uint32_t ready_mask) const;
+
+            static void TaskEntry(void *argument);
+            void Spin();
+        };
+    }
+}
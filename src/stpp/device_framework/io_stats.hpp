@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 延迟直方图，按 2 的幂分桶，单位是统计时钟的计数值（见 ByteDevice::SetStatsClock()）
+         * @note buckets[0] 统计延迟为 0 的次数，buckets[i] 统计延迟在 [2^(i-1), 2^i) 之间的次数，最后一个桶还包括更长的延迟
+         *
+         */
+        struct LatencyHistogram {
+            static constexpr std::size_t kBucketCount = 24;
+
+            uint32_t buckets[kBucketCount] = {};
+            uint32_t count                 = 0; // 样本数
+            uint32_t max                   = 0; // 最大延迟
+
+            /**
+             * @brief 延迟 ticks 所在的桶
+             *
+             */
+            static std::size_t GetBucket(uint32_t ticks)
+            {
+                std::size_t bucket = 0;
+                while (ticks != 0 && bucket < kBucketCount - 1) {
+                    ticks >>= 1;
+                    bucket++;
+                }
+                return bucket;
+            }
+
+            /**
+             * @brief 第 bucket 个桶的上界（不含）。最后一个桶没有上界，返回 UINT32_MAX
+             *
+             */
+            static uint32_t GetBucketUpperBound(std::size_t bucket)
+            {
+                return bucket >= kBucketCount - 1 ? UINT32_MAX : static_cast<uint32_t>(1) << bucket;
+            }
+
+            /**
+             * @brief 估计第 percent 百分位的延迟：返回该样本所在桶的上界，但不超过 max
+             *
+             * @param percent 范围 [0, 100]
+             * @return uint32_t 没有样本时返回 0
+             */
+            uint32_t GetPercentile(uint32_t percent) const
+            {
+                if (count == 0) {
+                    return 0;
+                }
+
+                // 第 rank 个样本（从 1 开始），向上取整
+                auto rank = (static_cast<uint64_t>(count) * percent + 99) / 100;
+                if (rank == 0) {
+                    rank = 1;
+                }
+
+                uint64_t seen = 0;
+                for (std::size_t i = 0; i < kBucketCount; i++) {
+                    seen += buckets[i];
+                    if (seen >= rank) {
+                        auto bound = GetBucketUpperBound(i);
+                        return bound > max ? max : bound;
+                    }
+                }
+                return max;
+            }
+        };
+
+        /**
+         * @brief ByteDevice 统计数据的快照，见 ByteDevice::GetStats()
+         *
+         */
+        struct IoStats {
+            uint32_t tx_bytes     = 0; // 成功发送的字节数
+            uint32_t tx_requests  = 0; // 成功完成的写请求数
+            uint32_t tx_transfers = 0; // driver_ 启动的发送传输次数（合并发送算一次，分段发送每段算一次）
+            uint32_t tx_errors    = 0; // 失败或被中止的写请求数
+
+            uint32_t rx_bytes     = 0; // 成功接收的字节数
+            uint32_t rx_requests  = 0; // 成功完成的读请求数
+            uint32_t rx_transfers = 0; // driver_ 启动的接收传输次数（流式接收时为 0）
+            uint32_t rx_errors    = 0; // 失败或被中止的读请求数
+            uint32_t rx_overflows = 0; // 流式接收丢失数据的次数
+
+            uint32_t tx_queue_high_water = 0; // 所有发送队列中的请求总数的最大值
+            uint32_t rx_queue_high_water = 0; // 接收队列中的请求数的最大值
+            uint32_t alloc_failures      = 0; // 复制模式分配缓冲区失败的次数
+
+            LatencyHistogram tx_queue_latency;   // 写请求从入队到开始发送
+            LatencyHistogram tx_service_latency; // 写请求从开始发送到完成
+            LatencyHistogram rx_queue_latency;   // 读请求从入队到开始接收（流式接收时到数据足够）
+            LatencyHistogram rx_service_latency; // 读请求从开始接收到完成（流式接收时不统计）
+        };
+    }
+}
@@ -0,0 +1,45 @@
+#include "io_trace.hpp"
+
+#ifdef STPP_IO_TRACE
+
+#include "byte_device.hpp"
+
+stpp::device::io_trace::Buffer stpp_io_trace;
+
+namespace stpp
+{
+    namespace device
+    {
+        namespace io_trace
+        {
+            namespace io_trace_internal
+            {
+                ClockFunc_t clock = nullptr;
+            }
+
+            static std::atomic<uint8_t> next_device_id{0};
+
+            void SetClock(ClockFunc_t clock, uint32_t clock_hz)
+            {
+                io_trace_internal::clock = clock;
+                stpp_io_trace.clock_hz   = clock_hz;
+            }
+
+            uint8_t AllocateDeviceId()
+            {
+                return next_device_id.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            bool Dump(ByteDevice &port, uint32_t timeout)
+            {
+                auto was_enabled = stpp_io_trace.is_enabled.exchange(false);
+                auto ok = port.SyncWrite(&stpp_io_trace, sizeof(stpp_io_trace), timeout);
+
+                stpp_io_trace.is_enabled.store(was_enabled);
+                return ok;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+#pragma once
+
+/**
+ * @file io_trace.hpp
+ * @brief I/O 路径的二进制事件追踪。编译时定义 STPP_IO_TRACE 才开启，否则 STPP_IO_TRACE_EVENT 不产生任何代码
+ * @note STPP_IO_TRACE 会改变 ByteDevice 的布局，必须在编译选项中全局定义，不要只在部分文件中定义
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef STPP_IO_TRACE_CAPACITY
+#define STPP_IO_TRACE_CAPACITY 1024 // 环形缓冲区能容纳的事件数，必须是 2 的幂
+#endif
+
+namespace stpp
+{
+    namespace device
+    {
+        class ByteDevice;
+
+        namespace io_trace
+        {
+            enum class EventType : uint8_t {
+                kTxEnqueue       = 1,  // 写请求入队，length 为数据长度
+                kRxEnqueue       = 2,  // 读请求入队
+                kDispatch        = 3,  // 守护线程/调度器/中断中开始调度，request_id 为通知位
+                kTxStart         = 4,  // driver_->AsyncWrite() 开始发送，合并发送时 request_id 为 0xFFFFFFFF
+                kRxStart         = 5,  // driver_->AsyncRead() 开始接收
+                kTxIrq           = 6,  // 发送完成中断
+                kRxIrq           = 7,  // 接收完成中断
+                kTxCallbackBegin = 8,  // 开始调用写请求的回调函数，length 为 ErrorCode
+                kTxCallbackEnd   = 9,  // 写请求的回调函数返回
+                kRxCallbackBegin = 10, // 开始调用读请求的回调函数，length 为 ErrorCode
+                kRxCallbackEnd   = 11, // 读请求的回调函数返回
+            };
+
+            /**
+             * @brief 一个事件，12 字节
+             *
+             */
+            struct Event {
+                uint32_t timestamp;  // 追踪时钟的计数值
+                uint32_t request_id; // 请求 id
+                uint16_t length;     // 数据长度等参数，超过 65535 时截断
+                uint8_t device_id;   // ByteDevice 的追踪 id，按构造顺序从 0 开始
+                EventType type;
+            };
+            static_assert(sizeof(Event) == 12, "Event layout is part of the dump format");
+
+            constexpr uint32_t kMagic   = 0x54505453; // "STPT"，小端
+            constexpr uint16_t kVersion = 1;
+
+            constexpr std::size_t kCapacity = STPP_IO_TRACE_CAPACITY;
+            static_assert(kCapacity != 0 && (kCapacity & (kCapacity - 1)) == 0, "STPP_IO_TRACE_CAPACITY must be a power of 2");
+
+            /**
+             * @brief 追踪缓冲区。内存中的布局就是导出格式，可以直接用调试器读出 stpp_io_trace 符号处的内存
+             * @note head 是累计记录的事件数。head 不超过 kCapacity 时事件是 events[0, head)；否则缓冲区已满，最旧的事件在 events[head % kCapacity]
+             *
+             */
+            struct Buffer {
+                uint32_t magic       = kMagic;
+                uint16_t version     = kVersion;
+                uint16_t event_size  = sizeof(Event);
+                uint32_t capacity    = kCapacity;
+                uint32_t clock_hz    = 0; // 追踪时钟的频率，为 0 时转换工具把计数值当作微秒
+                std::atomic<uint32_t> head{0};
+                std::atomic<bool> is_enabled{true};
+                uint8_t reserved[3] = {};
+                Event events[kCapacity];
+            };
+
+            using ClockFunc_t = uint32_t (*)();
+        }
+    }
+}
+
+#ifdef STPP_IO_TRACE
+
+// 固定的 C 符号名，调试器可以直接导出：dump binary memory trace.bin &stpp_io_trace ((char *)&stpp_io_trace) + sizeof(stpp_io_trace)
+extern "C" stpp::device::io_trace::Buffer stpp_io_trace;
+
+namespace stpp
+{
+    namespace device
+    {
+        namespace io_trace
+        {
+            namespace io_trace_internal
+            {
+                extern ClockFunc_t clock;
+            }
+
+            /**
+             * @brief 设置追踪时钟，如 HPT_GetTotalSysTick
+             *
+             * @param clock_hz 时钟频率，写入导出数据，供转换工具换算时间
+             */
+            void SetClock(ClockFunc_t clock, uint32_t clock_hz);
+
+            /**
+             * @brief 分配一个设备追踪 id。由 ByteDevice 构造时调用
+             *
+             */
+            uint8_t AllocateDeviceId();
+
+            /**
+             * @brief 记录一个事件。无锁，可以在中断中调用；缓冲区满时覆盖最旧的事件
+             *
+             */
+            inline void Record(EventType type, uint8_t device_id, uint32_t request_id, std::size_t length)
+            {
+                if (!stpp_io_trace.is_enabled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                auto index       = stpp_io_trace.head.fetch_add(1, std::memory_order_relaxed) & (kCapacity - 1);
+                auto &event      = stpp_io_trace.events[index];
+                auto clock       = io_trace_internal::clock;
+                event.timestamp  = clock == nullptr ? 0 : clock();
+                event.request_id = request_id;
+                event.length     = length > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(length);
+                event.device_id  = device_id;
+                event.type       = type;
+            }
+
+            /**
+             * @brief 暂停追踪，把缓冲区原样通过 port 发出，然后恢复追踪。不能在中断上下文中调用
+             * @note 导出期间所有设备的事件都不会被记录，包括 port 自己的 I/O。暂停时恰好被打断的写入可能留下一个不完整的事件，转换工具会跳过它
+             * @note 用 stpp/tools/io_trace_to_chrome.py 转换成 Chrome/Perfetto 的 JSON
+             *
+             * @return true 导出成功
+             */
+            bool Dump(ByteDevice &port, uint32_t timeout = UINT32_MAX);
+
+#define STPP_IO_TRACE_EVENT(type, device_id, request_id, length) \
+    ::stpp::device::io_trace::Record(::stpp::device::io_trace::EventType::type, device_id, request_id, length)
+        }
+    }
+}
+
+#else
+#define STPP_IO_TRACE_EVENT(type, device_id, request_id, length) ((void)0)
+#endif
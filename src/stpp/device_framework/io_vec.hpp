@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 一段数据，用于分散-聚集（scatter-gather）写入
+         *
+         */
+        struct IoVec {
+            const void *data;
+            std::size_t length;
+        };
+    }
+}
@@ -0,0 +1,83 @@
+#include "line_reader.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        bool LineReader::ReadLine(std::string_view &line, uint32_t timeout)
+        {
+            while (true) {
+                if (!device_.SyncReadUntil(buffer_.get(), capacity_, '\n', received_length_, timeout)) {
+                    return false;
+                }
+
+                if (TakeLine(line)) {
+                    return true;
+                }
+            }
+        }
+
+        bool LineReader::AsyncReadLine(LineCallbackFunc_t callback)
+        {
+            callback_ = std::move(callback);
+            return Submit();
+        }
+
+        bool LineReader::Cancel()
+        {
+            return device_.CancelRead(request_id_);
+        }
+
+        bool LineReader::Submit()
+        {
+            return device_.AsyncReadUntil(
+                buffer_.get(), capacity_, '\n', &received_length_, [this](stpp::ErrorCode ec) {
+                    OnReceived(ec);
+                },
+                &request_id_);
+        }
+
+        void LineReader::OnReceived(stpp::ErrorCode ec)
+        {
+            request_id_ = ByteDevice::kInvalidRequestId;
+
+            std::string_view line;
+            if (ec == stpp::ErrorCode::OK && !TakeLine(line)) {
+                // 丢弃了被截断的行的剩余部分，继续读取真正的下一行
+                if (Submit()) {
+                    return;
+                }
+                ec = stpp::ErrorCode::ERROR;
+            }
+
+            // 回调函数中可能再次调用 AsyncReadLine() 覆盖 callback_，所以先移出来
+            auto callback = std::move(callback_);
+            callback_     = nullptr;
+            if (callback) {
+                callback(ec, line);
+            }
+        }
+
+        bool LineReader::TakeLine(std::string_view &line)
+        {
+            auto length   = received_length_;
+            auto is_whole = length > 0 && buffer_[length - 1] == '\n';
+
+            if (is_discarding_) {
+                is_discarding_ = !is_whole;
+                return false;
+            }
+            is_discarding_ = !is_whole;
+
+            if (is_whole) {
+                length--;
+                if (length > 0 && buffer_[length - 1] == '\r') {
+                    length--;
+                }
+            }
+
+            line = std::string_view(buffer_.get(), length);
+            return true;
+        }
+    }
+}
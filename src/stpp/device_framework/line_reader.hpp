@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include "byte_device.hpp"
+#include "../error_code.hpp"
+#include "../inplace_function.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 按行读取 ByteDevice 的数据，用于文本命令、NMEA 等以换行结尾的协议。只能用于流式接收的设备
+         * @note 基于 ByteDevice::AsyncReadUntil()，换行符一到立即完成，下一行的数据留在设备的环形缓冲区中
+         * @note 返回的行不包括行尾的 "\n" 和 "\r\n"，指向内部缓冲区，下次读取之前有效。
+         *       超过 max_line_length 的行被截断，剩余部分被丢弃
+         * @note 同一时刻只能有一个读取在进行
+         *
+         */
+        class LineReader
+        {
+        public:
+            using LineCallbackFunc_t = stpp::InplaceFunction<void(stpp::ErrorCode, std::string_view line)>;
+
+            /**
+             * @param device 要读取的设备，必须已开启流式接收
+             * @param max_line_length 一行最多的字节数，包括行尾的换行符。必须小于设备的环形缓冲区大小
+             */
+            LineReader(ByteDevice &device, std::size_t max_line_length)
+                : device_(device), buffer_(std::make_unique<char[]>(max_line_length)), capacity_(max_line_length) {};
+
+            LineReader(LineReader &&)                 = delete;
+            LineReader(const LineReader &)            = delete;
+            LineReader &operator=(LineReader &&)      = delete;
+            LineReader &operator=(const LineReader &) = delete;
+
+            /**
+             * @brief 读取一行，线程会阻塞直到读到一整行。不能在中断上下文中调用
+             * @note 需要先丢弃上一个被截断的行的剩余部分时，每一段分别计算超时
+             *
+             * @param line 读到的行
+             * @param timeout 超时时间，单位 ms。超时后已收到的部分留在设备中，下次继续读取
+             * @return true 成功
+             * @return false 失败或超时
+             */
+            bool ReadLine(std::string_view &line, uint32_t timeout = std::numeric_limits<uint32_t>::max());
+
+            /**
+             * @brief 异步读取一行，不会阻塞。可以在中断上下文中调用，也可以在回调函数中调用以读取下一行
+             * @note 回调函数的执行上下文与 ByteDevice 的回调函数相同
+             *
+             * @return true 成功
+             * @return false 失败，回调函数不会被调用
+             */
+            bool AsyncReadLine(LineCallbackFunc_t callback);
+
+            /**
+             * @brief 取消正在进行的 AsyncReadLine()。成功取消时以 ErrorCode::CANCELLED 调用回调函数
+             *
+             */
+            bool Cancel();
+
+        private:
+            ByteDevice &device_;
+            std::unique_ptr<char[]> buffer_;
+            std::size_t capacity_;
+            std::size_t received_length_ = 0;
+            bool is_discarding_          = false; // 上一行被截断，正在丢弃它的剩余部分
+            LineCallbackFunc_t callback_;
+            ByteDevice::RequestId_t request_id_ = ByteDevice::kInvalidRequestId;
+
+            bool Submit();
+            void OnReceived(stpp::ErrorCode ec);
+
+            /**
+             * @brief 处理读到的一段数据
+             *
+             * @return true 读到了一整行（可能被截断），保存在 line 中
+             * @return false 这一段是被截断的行的剩余部分，已丢弃
+             */
+            bool TakeLine(std::string_view &line);
+        };
+    }
+}
@@ -1,12 +1,12 @@
 #pragma once
 
 #include "../../error_code.hpp"
-#include <functional>
+#include "../../inplace_function.hpp"
 
 namespace stpp
 {
     namespace device_framework_internal
     {
-        using CallbackFunc_t = std::function<void(stpp::ErrorCode)>;
+        using CallbackFunc_t = stpp::InplaceFunction<void(stpp::ErrorCode)>;
     }
 }
\ No newline at end of file
@@ -2,7 +2,14 @@
 
 #include <cstring>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
 #include "callback_func.hpp"
+#include "tx_buffer_pool.hpp"
+#include "../io_vec.hpp"
+#include "../tx_buffer.hpp"
+#include "../tx_priority.hpp"
 #include "../../freertos_memory.hpp"
 
 namespace stpp
@@ -13,50 +20,194 @@ namespace stpp
         class TxDataWithCallback
         {
         public:
-            std::shared_ptr<const uint8_t[]> data_;
-            size_t length_;
+            static constexpr std::size_t kMaxFragments = 4; // 不拷贝的分散写入最多支持的片段数
+
+            device::TxBuffer buffer_; // 复制模式下存放数据的缓冲区
+            size_t length_;           // 所有片段的总长度
             CallbackFunc_t callback_;
 
+            device::IoVec fragments_[kMaxFragments]{}; // 要依次发送的片段
+            std::size_t fragment_count_  = 0;
+            std::size_t fragment_index_  = 0; // 正在发送的片段
+            std::size_t fragment_offset_ = 0; // 正在发送的片段中已发送完的字节数
+            std::size_t chunk_length_    = 0; // 正在发送的这一段的长度
+
+            bool is_copied_ = false; // 数据是否由 buffer_ 持有（复制模式或接管所有权），此时可以合并发送并提前释放 buffer_
+
+            uint32_t id_ = 0; // 请求 id，用于取消请求
+
+            device::TxPriority priority_ = device::TxPriority::kNormal; // 所在的发送队列
+
+            uint32_t enqueue_time_ = 0; // 入队时间，用于统计延迟
+            uint32_t start_time_   = 0; // 开始发送的时间
+
             TxDataWithCallback()
-                : data_(nullptr), length_(0), callback_() {};
+                : length_(0), callback_() {};
 
             /**
-             * @brief 构建一个 TxDataWithCallback 对象。该对象将数据拷贝到内部。
-             *
+             * @brief 构建一个 TxDataWithCallback 对象。该对象将数据拷贝到从 pool 分配的缓冲区中。
+             * @note 内存不足时抛出 std::bad_alloc
              */
-            TxDataWithCallback(Mallocator_t &mem_, const uint8_t *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
-                : length_(length), callback_(std::move(callback))
+            TxDataWithCallback(TxBufferPool<Mallocator_t> &pool, const uint8_t *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
+                : buffer_(pool.Allocate(length)), length_(length), callback_(std::move(callback))
+            {
+                std::memcpy(buffer_.GetData(), data, length);
+                is_copied_ = true;
+                SetSingleFragment();
+            }
+
+            /**
+             * @brief 构建一个 TxDataWithCallback 对象。该对象将所有片段依次拷贝到从 pool 分配的同一个缓冲区中。
+             * @note 内存不足时抛出 std::bad_alloc
+             */
+            TxDataWithCallback(TxBufferPool<Mallocator_t> &pool, const device::IoVec *vecs, std::size_t count, CallbackFunc_t callback = CallbackFunc_t())
+                : length_(TotalLength(vecs, count)), callback_(std::move(callback))
+            {
+                buffer_ = pool.Allocate(length_);
+
+                auto ptr = buffer_.GetData();
+                for (std::size_t i = 0; i < count; i++) {
+                    if (vecs[i].length == 0) continue; // 空片段的 data 可以为空指针
+
+                    std::memcpy(ptr, vecs[i].data, vecs[i].length);
+                    ptr += vecs[i].length;
+                }
+
+                is_copied_ = true;
+                SetSingleFragment();
+            }
+
+            /**
+             * @brief 构建一个 TxDataWithCallback 对象。该对象只保存各片段的指针，不拷贝数据，不负责释放内存。
+             * @note 非空片段数超过 kMaxFragments 时抛出 std::invalid_argument
+             */
+            TxDataWithCallback(const device::IoVec *vecs, std::size_t count, CallbackFunc_t callback = CallbackFunc_t())
+                : length_(0), callback_(std::move(callback))
             {
-                auto new_data = static_cast<uint8_t *>(mem_.Malloc(length));
-                std::memcpy(new_data, data, length);
-                data_.reset(new_data, std::bind(&Mallocator_t::Free, &mem_, std::placeholders::_1, length));
+                for (std::size_t i = 0; i < count; i++) {
+                    if (vecs[i].length == 0) continue;
+                    if (fragment_count_ >= kMaxFragments) throw std::invalid_argument("Too many fragments");
+
+                    fragments_[fragment_count_++] = vecs[i];
+                    length_ += vecs[i].length;
+                }
             }
 
             /**
-             * @brief 构建一个 TxDataWithCallback 对象。该对象只保存指针，不拷贝数据，使用智能指针管理内存。
+             * @brief 构建一个 TxDataWithCallback 对象。该对象接管已填好数据的缓冲区，不拷贝数据。
              *
              */
-            TxDataWithCallback(std::shared_ptr<const uint8_t[]> data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
-                : data_(std::move(data)), length_(length), callback_(std::move(callback)) {};
+            TxDataWithCallback(device::TxBuffer buffer, CallbackFunc_t callback = CallbackFunc_t())
+                : buffer_(std::move(buffer)), length_(buffer_.GetLength()), callback_(std::move(callback))
+            {
+                is_copied_ = true;
+                SetSingleFragment();
+            }
+
+            /**
+             * @brief 构建一个 TxDataWithCallback 对象。该对象接管 owner 的所有权，不拷贝数据，data 指向 owner 管理的内存。
+             * @note owner 放在从 pool 分配的缓冲区中，请求结束时随缓冲区一起析构。内存不足时抛出 std::bad_alloc，此时 owner 不会被移动
+             */
+            template <typename Owner_t>
+            TxDataWithCallback(TxBufferPool<Mallocator_t> &pool, Owner_t &&owner, const uint8_t *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
+                : buffer_(pool.AllocateOwner(std::forward<Owner_t>(owner))), length_(length), callback_(std::move(callback))
+            {
+                fragments_[0]   = {data, length};
+                fragment_count_ = 1;
+                is_copied_      = true;
+            }
 
             /**
              * @brief 构建一个 TxDataWithCallback 对象。该对象只保存指针，不拷贝数据，不负责释放内存。
              *
              */
             TxDataWithCallback(const uint8_t *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
-                : data_(data, [](const void *) {}), length_(length), callback_(std::move(callback)) {};
+                : length_(length), callback_(std::move(callback))
+            {
+                fragments_[0]   = {data, length};
+                fragment_count_ = 1;
+            }
 
             void Clear()
             {
-                data_.reset();
-                length_   = 0;
-                callback_ = CallbackFunc_t();
+                buffer_.Reset();
+                length_         = 0;
+                callback_       = CallbackFunc_t();
+                fragment_count_  = 0;
+                fragment_index_  = 0;
+                fragment_offset_ = 0;
+                chunk_length_    = 0;
+                is_copied_       = false;
+                id_              = 0;
+                priority_        = device::TxPriority::kNormal;
+                enqueue_time_    = 0;
+                start_time_      = 0;
             }
 
             bool IsEmpty() const
             {
                 return length_ == 0;
             }
+
+            /**
+             * @brief 获取下一段要发送的数据：正在发送的片段中尚未发送的部分
+             *
+             * @param max_length 最多发送的字节数，为 0 时不限制
+             */
+            device::IoVec NextChunk(std::size_t max_length)
+            {
+                auto &fragment = fragments_[fragment_index_];
+                auto length    = fragment.length - fragment_offset_;
+                if (max_length != 0 && length > max_length) {
+                    length = max_length;
+                }
+
+                chunk_length_ = length;
+                return {static_cast<const uint8_t *>(fragment.data) + fragment_offset_, length};
+            }
+
+            /**
+             * @brief NextChunk() 取出的一段已发送完
+             *
+             * @return true 还有数据需要发送
+             * @return false 所有片段已发送完
+             */
+            bool FinishChunk()
+            {
+                fragment_offset_ += chunk_length_;
+                chunk_length_ = 0;
+                if (fragment_offset_ >= fragments_[fragment_index_].length) {
+                    fragment_index_++;
+                    fragment_offset_ = 0;
+                }
+                return fragment_index_ < fragment_count_;
+            }
+
+            /**
+             * @brief 是否已经发送了一部分数据
+             *
+             */
+            bool IsStarted() const
+            {
+                return fragment_index_ != 0 || fragment_offset_ != 0;
+            }
+
+        private:
+            void SetSingleFragment()
+            {
+                fragments_[0]   = {buffer_.GetData(), length_};
+                fragment_count_ = 1;
+                fragment_index_ = 0;
+            }
+
+            static std::size_t TotalLength(const device::IoVec *vecs, std::size_t count)
+            {
+                std::size_t length = 0;
+                for (std::size_t i = 0; i < count; i++) {
+                    length += vecs[i].length;
+                }
+                return length;
+            }
         };
 
         class RxDataWithCallback
@@ -65,6 +216,15 @@ namespace stpp
             std::shared_ptr<uint8_t[]> data_;
             size_t length_;
             CallbackFunc_t callback_;
+            uint32_t id_           = 0; // 请求 id，用于取消请求
+            uint32_t enqueue_time_ = 0; // 入队时间，用于统计延迟
+            uint32_t start_time_   = 0; // 开始接收的时间
+
+            bool is_until_                = false;   // 读到 delimiter_ 为止，length_ 为最多读取的字节数。只用于流式接收
+            uint8_t delimiter_            = 0;
+            std::size_t *received_length_ = nullptr; // 不为空时保存实际读取的字节数
+            std::size_t scanned_          = 0;       // 已查找过、不含分隔符的字节数，下次从这里继续查找
+            uint32_t scan_base_           = 0;       // 查找时环形缓冲区的读出计数，读出位置变化后 scanned_ 作废
 
             RxDataWithCallback()
                 : data_(nullptr), length_(0), callback_() {};
@@ -78,16 +238,25 @@ namespace stpp
 
             /**
              * @brief 构建一个 RxDataWithCallback 对象。该对象不负责释放内存。
-             *
+             * @note 用空的 shared_ptr 别名指向 data，不分配控制块，可以在临界区中构建
              */
             RxDataWithCallback(uint8_t *data, std::size_t length, CallbackFunc_t callback = CallbackFunc_t())
-                : data_(data, [](uint8_t *) {}), length_(length), callback_(std::move(callback)) {};
+                : data_(std::shared_ptr<uint8_t[]>(), data), length_(length), callback_(std::move(callback)) {};
 
             void Clear()
             {
                 data_.reset();
-                length_   = 0;
-                callback_ = CallbackFunc_t();
+                length_       = 0;
+                callback_     = CallbackFunc_t();
+                id_           = 0;
+                enqueue_time_ = 0;
+                start_time_   = 0;
+
+                is_until_        = false;
+                delimiter_       = 0;
+                received_length_ = nullptr;
+                scanned_         = 0;
+                scan_base_       = 0;
             }
 
             bool IsEmpty() const
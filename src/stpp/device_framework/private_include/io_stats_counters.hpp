@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "../io_stats.hpp"
+
+namespace stpp
+{
+    namespace device_framework_internal
+    {
+        /**
+         * @brief 正在统计的延迟直方图。每次记录只有几次无锁的原子操作，可以在中断中调用
+         *
+         */
+        class AtomicHistogram
+        {
+        public:
+            void Record(uint32_t ticks)
+            {
+                buckets_[device::LatencyHistogram::GetBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+                count_.fetch_add(1, std::memory_order_relaxed);
+
+                auto max = max_.load(std::memory_order_relaxed);
+                while (ticks > max && !max_.compare_exchange_weak(max, ticks, std::memory_order_relaxed)) {}
+            }
+
+            void Snapshot(device::LatencyHistogram &histogram) const
+            {
+                for (std::size_t i = 0; i < device::LatencyHistogram::kBucketCount; i++) {
+                    histogram.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+                }
+                histogram.count = count_.load(std::memory_order_relaxed);
+                histogram.max   = max_.load(std::memory_order_relaxed);
+            }
+
+            void Reset()
+            {
+                for (auto &bucket : buckets_) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                count_.store(0, std::memory_order_relaxed);
+                max_.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<uint32_t> buckets_[device::LatencyHistogram::kBucketCount] = {};
+            std::atomic<uint32_t> count_{0};
+            std::atomic<uint32_t> max_{0};
+        };
+
+        /**
+         * @brief ByteDevice 一直开启的统计计数器
+         * @note 各计数器分别原子地更新，快照不是严格一致的，只用于监控和调优
+         *
+         */
+        struct IoStatsCounters {
+            std::atomic<uint32_t> tx_bytes{0};
+            std::atomic<uint32_t> tx_requests{0};
+            std::atomic<uint32_t> tx_transfers{0};
+            std::atomic<uint32_t> tx_errors{0};
+
+            std::atomic<uint32_t> rx_bytes{0};
+            std::atomic<uint32_t> rx_requests{0};
+            std::atomic<uint32_t> rx_transfers{0};
+            std::atomic<uint32_t> rx_errors{0};
+
+            std::atomic<uint32_t> tx_queue_high_water{0};
+            std::atomic<uint32_t> rx_queue_high_water{0};
+
+            AtomicHistogram tx_queue_latency;
+            AtomicHistogram tx_service_latency;
+            AtomicHistogram rx_queue_latency;
+            AtomicHistogram rx_service_latency;
+
+            static void Add(std::atomic<uint32_t> &counter, uint32_t value = 1)
+            {
+                counter.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            static void UpdateMax(std::atomic<uint32_t> &counter, uint32_t value)
+            {
+                auto max = counter.load(std::memory_order_relaxed);
+                while (value > max && !counter.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+            }
+
+            void Snapshot(device::IoStats &stats) const
+            {
+                stats.tx_bytes            = tx_bytes.load(std::memory_order_relaxed);
+                stats.tx_requests         = tx_requests.load(std::memory_order_relaxed);
+                stats.tx_transfers        = tx_transfers.load(std::memory_order_relaxed);
+                stats.tx_errors           = tx_errors.load(std::memory_order_relaxed);
+                stats.rx_bytes            = rx_bytes.load(std::memory_order_relaxed);
+                stats.rx_requests         = rx_requests.load(std::memory_order_relaxed);
+                stats.rx_transfers        = rx_transfers.load(std::memory_order_relaxed);
+                stats.rx_errors           = rx_errors.load(std::memory_order_relaxed);
+                stats.tx_queue_high_water = tx_queue_high_water.load(std::memory_order_relaxed);
+                stats.rx_queue_high_water = rx_queue_high_water.load(std::memory_order_relaxed);
+                tx_queue_latency.Snapshot(stats.tx_queue_latency);
+                tx_service_latency.Snapshot(stats.tx_service_latency);
+                rx_queue_latency.Snapshot(stats.rx_queue_latency);
+                rx_service_latency.Snapshot(stats.rx_service_latency);
+            }
+
+            void Reset()
+            {
+                for (auto counter : {&tx_bytes, &tx_requests, &tx_transfers, &tx_errors, &rx_bytes, &rx_requests, &rx_transfers, &rx_errors, &tx_queue_high_water, &rx_queue_high_water}) {
+                    counter->store(0, std::memory_order_relaxed);
+                }
+                tx_queue_latency.Reset();
+                tx_service_latency.Reset();
+                rx_queue_latency.Reset();
+                rx_service_latency.Reset();
+            }
+        };
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include "../../find_byte.hpp"
+
+namespace stpp
+{
+    namespace device_framework_internal
+    {
+        /**
+         * @brief 流式接收的环形缓冲区。硬件（DMA）循环写入，中断中发布写入位置，消费者从中读出
+         * @note 单生产者（中断）单消费者。读写位置用不回绕的 32 位累计字节数表示，所以容量必须是 2 的幂
+         */
+        class StreamRxRing
+        {
+        public:
+            StreamRxRing(std::size_t capacity)
+                : capacity_(capacity)
+            {
+                assert(capacity != 0 && (capacity & (capacity - 1)) == 0); // 容量必须是 2 的幂
+                buffer_ = new uint8_t[capacity];
+            }
+
+            StreamRxRing(const StreamRxRing &)            = delete;
+            StreamRxRing &operator=(const StreamRxRing &) = delete;
+
+            ~StreamRxRing()
+            {
+                delete[] buffer_;
+            }
+
+            uint8_t *GetBuffer() const
+            {
+                return buffer_;
+            }
+
+            std::size_t GetCapacity() const
+            {
+                return capacity_;
+            }
+
+            /**
+             * @brief 单次读取的最大长度。未读数据达到容量时按溢出处理（见 Resync()），所以容量个字节的读取永远不会满足
+             *
+             */
+            std::size_t GetMaxReadLength() const
+            {
+                return capacity_ - 1;
+            }
+
+            /**
+             * @brief 发布硬件的写入位置。在中断中调用
+             *
+             * @param write_pos 硬件下一个要写入的位置，范围 [0, capacity)
+             */
+            void Publish(std::size_t write_pos)
+            {
+                auto delta      = (write_pos - last_write_pos_) & (capacity_ - 1);
+                last_write_pos_ = write_pos;
+                written_.store(written_.load(std::memory_order_relaxed) + delta, std::memory_order_release);
+            }
+
+            /**
+             * @brief 硬件从头重新开始写入。在中断中调用，尚未读出的数据全部丢弃
+             *
+             */
+            void Restart()
+            {
+                // 把累计写入数向上对齐到容量的整数倍，使其与硬件的写入位置 0 对应
+                auto written    = written_.load(std::memory_order_relaxed);
+                written         = (written + capacity_ - 1) & ~static_cast<uint32_t>(capacity_ - 1);
+                last_write_pos_ = 0;
+                resync_to_.store(written, std::memory_order_relaxed);
+                written_.store(written, std::memory_order_release);
+                is_restarted_.store(true, std::memory_order_release);
+            }
+
+            /**
+             * @brief 获取可读出的字节数。由消费者调用
+             *
+             */
+            std::size_t GetSize()
+            {
+                Resync();
+                return written_.load(std::memory_order_acquire) - read_;
+            }
+
+            /**
+             * @brief 获取从 offset 开始、在缓冲区中连续的可读数据。由消费者调用
+             *
+             * @return std::tuple<const uint8_t *, std::size_t> 数据指针和长度
+             */
+            std::tuple<const uint8_t *, std::size_t> Peek(std::size_t offset = 0)
+            {
+                auto size = GetSize();
+                if (offset >= size) {
+                    return {buffer_, 0};
+                }
+
+                auto index = (read_ + offset) & (capacity_ - 1);
+                auto len   = size - offset;
+                if (len > capacity_ - index) {
+                    len = capacity_ - index;
+                }
+                return {buffer_ + index, len};
+            }
+
+            /**
+             * @brief 在可读数据的 [offset, end) 范围内查找 value。由消费者调用
+             * @note end 不能超过 GetSize()。数据跨越缓冲区末尾时分两段查找
+             *
+             * @return std::size_t 第一个匹配的位置（相对于可读数据的开头），没有找到时返回 end
+             */
+            std::size_t Find(uint8_t value, std::size_t offset, std::size_t end)
+            {
+                while (offset < end) {
+                    auto [data, len] = Peek(offset);
+                    if (len == 0) {
+                        break;
+                    }
+                    if (len > end - offset) {
+                        len = end - offset;
+                    }
+
+                    auto index = FindByte(data, len, value);
+                    if (index < len) {
+                        return offset + index;
+                    }
+                    offset += len;
+                }
+                return end;
+            }
+
+            /**
+             * @brief 消费者累计读出的字节数（会回绕）。读出、丢弃或因溢出跳过数据后都会改变，用于判断可读数据的开头是否移动过
+             *
+             */
+            uint32_t GetReadCount()
+            {
+                Resync();
+                return read_;
+            }
+
+            /**
+             * @brief 丢弃前 length 个字节。由消费者调用
+             *
+             */
+            void Consume(std::size_t length)
+            {
+                read_ += length;
+            }
+
+            /**
+             * @brief 读出数据。由消费者调用
+             *
+             * @return std::size_t 实际读出的字节数
+             */
+            std::size_t Read(uint8_t *data, std::size_t length)
+            {
+                auto size = GetSize();
+                if (length > size) {
+                    length = size;
+                }
+
+                auto index = read_ & (capacity_ - 1);
+                auto first = capacity_ - index;
+                if (first > length) {
+                    first = length;
+                }
+
+                std::memcpy(data, buffer_ + index, first);
+                std::memcpy(data + first, buffer_, length - first);
+                read_ += length;
+                return length;
+            }
+
+            /**
+             * @brief 硬件累计写入的字节数（会回绕），用于判断是否有新数据到来
+             *
+             */
+            uint32_t GetWriteCount() const
+            {
+                return written_.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief 因硬件覆盖未读数据或出错重启而丢失数据的次数
+             *
+             */
+            uint32_t GetOverflowCount() const
+            {
+                return overflow_count_;
+            }
+
+        private:
+            uint8_t *buffer_;
+            std::size_t capacity_;
+
+            std::size_t last_write_pos_ = 0; // 中断侧：上次发布的写入位置
+            std::atomic<uint32_t> written_{0};
+            std::atomic<uint32_t> resync_to_{0};
+            std::atomic<bool> is_restarted_{false};
+
+            uint32_t read_           = 0; // 消费者侧：累计读出字节数
+            uint32_t overflow_count_ = 0;
+
+            void Resync()
+            {
+                if (is_restarted_.exchange(false, std::memory_order_acquire)) {
+                    read_ = resync_to_.load(std::memory_order_relaxed);
+                    overflow_count_++;
+                }
+
+                // 未读数据超过容量，说明最旧的数据已被硬件覆盖。最新的容量个字节也可能正在被覆盖，一并丢弃
+                auto written = written_.load(std::memory_order_acquire);
+                if (written - read_ >= capacity_) {
+                    read_ = written;
+                    overflow_count_++;
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "../../in_handle_mode.h"
+
+namespace stpp
+{
+    namespace device_framework_internal
+    {
+        /**
+         * @brief 线程通知值中用于唤醒等待 I/O 的线程的位。只置位和清除这一位，不影响线程通知值的其他位
+         *
+         */
+        constexpr uint32_t kWakeNotifyBit = 1u << 31;
+
+        /**
+         * @brief 唤醒在 WaitWake() 中等待的线程。可以在中断上下文中调用
+         *
+         */
+        inline void NotifyWake(TaskHandle_t task_handle)
+        {
+            if (InHandlerMode()) {
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+                xTaskNotifyFromISR(task_handle, kWakeNotifyBit, eSetBits, &xHigherPriorityTaskWoken);
+                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            } else {
+                xTaskNotify(task_handle, kWakeNotifyBit, eSetBits);
+            }
+        }
+
+        /**
+         * @brief 阻塞当前线程，直到被 NotifyWake() 唤醒或经过 ticks 个 tick
+         * @note 唤醒只是提示，调用者醒来后需要重新检查等待的条件
+         *
+         */
+        inline void WaitWake(TickType_t ticks)
+        {
+            xTaskNotifyWait(0, kWakeNotifyBit, nullptr, ticks);
+        }
+
+        /**
+         * @brief 从 start 开始等待 ticks 个 tick，还剩下的 tick 数。ticks 为 portMAX_DELAY 时永不超时
+         *
+         */
+        inline TickType_t GetRemainingTicks(TickType_t start, TickType_t ticks)
+        {
+            if (ticks == portMAX_DELAY) {
+                return portMAX_DELAY;
+            }
+
+            auto elapsed = xTaskGetTickCount() - start;
+            return elapsed >= ticks ? 0 : ticks - elapsed;
+        }
+    }
+}
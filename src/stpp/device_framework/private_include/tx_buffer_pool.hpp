@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../tx_buffer.hpp"
+#include "../../freertos_lock.hpp"
+
+namespace stpp
+{
+    namespace device_framework_internal
+    {
+        /**
+         * @brief 按大小分级的 TxBuffer 缓冲池
+         * @note 不超过最大级别的缓冲区释放后挂到对应级别的空闲链表上，下次直接复用，不再分配内存。
+         *       更大的缓冲区单独分配，释放时直接归还 mem_。mem_ 不足时先释放所有空闲缓冲区再重试
+         * @note 缓冲池必须在所有由它分配的 TxBuffer 销毁之后再销毁
+         */
+        template <typename Mallocator_t>
+        class TxBufferPool : public TxBufferRecycler
+        {
+        public:
+            static constexpr std::size_t kClassCount              = 4;
+            static constexpr std::size_t kClassSizes[kClassCount] = {32, 64, 128, 256}; // 各级别的数据区大小
+
+            TxBufferPool(Mallocator_t &mem)
+                : mem_(mem) {};
+
+            TxBufferPool(const TxBufferPool &)            = delete;
+            TxBufferPool &operator=(const TxBufferPool &) = delete;
+
+            ~TxBufferPool()
+            {
+                Trim();
+            }
+
+            /**
+             * @brief 分配一个至少能容纳 length 字节的缓冲区，有效数据长度设为 length
+             * @note mem_ 剩余空间不足时抛出 std::bad_alloc
+             */
+            device::TxBuffer Allocate(std::size_t length)
+            {
+                return device::TxBuffer(AllocateHeader(length));
+            }
+
+            /**
+             * @brief 把 owner 移入一个缓冲区，缓冲区的最后一个引用放弃时析构 owner。用于接管 std::vector 等对象的所有权
+             * @note 内存不足时抛出 std::bad_alloc，此时 owner 不会被移动
+             */
+            template <typename Owner_t>
+            device::TxBuffer AllocateOwner(Owner_t &&owner)
+            {
+                using T = std::decay_t<Owner_t>;
+                static_assert(alignof(T) <= alignof(TxBufferHeader), "Owner is over-aligned for the data area of a TxBuffer");
+                static_assert(std::is_nothrow_move_constructible_v<T>, "Owner must be nothrow move constructible");
+
+                auto header = AllocateHeader(sizeof(T));
+                new (header->GetData()) T(std::move(owner));
+                header->release_owner = [](TxBufferHeader *h) {
+                    reinterpret_cast<T *>(h->GetData())->~T();
+                };
+                return device::TxBuffer(header);
+            }
+
+            /**
+             * @brief 把所有空闲缓冲区归还 mem_
+             *
+             */
+            void Trim()
+            {
+                for (std::size_t i = 0; i < kClassCount; i++) {
+                    TxBufferHeader *header;
+                    {
+                        std::lock_guard lock(lock_);
+                        header         = free_lists_[i];
+                        free_lists_[i] = nullptr;
+                        for (auto p = header; p != nullptr; p = p->next_free) {
+                            cached_size_ -= GetBlockSize(p->capacity);
+                        }
+                    }
+
+                    while (header != nullptr) {
+                        auto next = header->next_free;
+                        Free(header);
+                        header = next;
+                    }
+                }
+            }
+
+            void Recycle(TxBufferHeader *header) override
+            {
+                if (header->release_owner != nullptr) {
+                    header->release_owner(header);
+                    header->release_owner = nullptr;
+                }
+
+                auto size_class = GetSizeClass(header->capacity);
+                if (size_class >= kClassCount || kClassSizes[size_class] != header->capacity) {
+                    Free(header);
+                    return;
+                }
+
+                std::lock_guard lock(lock_);
+                header->next_free       = free_lists_[size_class];
+                free_lists_[size_class] = header;
+                cached_size_ += GetBlockSize(header->capacity);
+            }
+
+            /**
+             * @brief 现在分配 length 字节的缓冲区能否成功（不考虑堆的碎片）
+             *
+             */
+            bool CanAllocate(std::size_t length)
+            {
+                auto size_class = GetSizeClass(length);
+                auto capacity   = size_class < kClassCount ? kClassSizes[size_class] : length;
+
+                std::lock_guard lock(lock_);
+                if (size_class < kClassCount && free_lists_[size_class] != nullptr) {
+                    return true;
+                }
+
+                // 空闲缓冲区可以被 Trim() 释放，也算作可用空间
+                auto used = mem_.GetAllocatedSize() - cached_size_;
+                return used + GetBlockSize(capacity) <= mem_.GetMaxSize();
+            }
+
+            /**
+             * @brief 分配失败的次数
+             *
+             */
+            uint32_t GetAllocFailureCount() const
+            {
+                return alloc_failure_count_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            Mallocator_t &mem_;
+            stpp::CriticalSection lock_;
+            TxBufferHeader *free_lists_[kClassCount] = {};
+            std::size_t cached_size_                 = 0; // 空闲链表上所有缓冲区占用的内存
+            std::atomic<uint32_t> alloc_failure_count_{0};
+
+            /**
+             * @brief 分配一个至少能容纳 length 字节的缓冲区，引用计数为 1
+             * @note mem_ 剩余空间不足时抛出 std::bad_alloc
+             */
+            TxBufferHeader *AllocateHeader(std::size_t length)
+            {
+                auto size_class = GetSizeClass(length);
+
+                TxBufferHeader *header = nullptr;
+                if (size_class < kClassCount) {
+                    std::lock_guard lock(lock_);
+                    header = free_lists_[size_class];
+                    if (header != nullptr) {
+                        free_lists_[size_class] = header->next_free;
+                        cached_size_ -= GetBlockSize(header->capacity);
+                    }
+                }
+
+                if (header == nullptr) {
+                    auto capacity = size_class < kClassCount ? kClassSizes[size_class] : length;
+
+                    auto block = mem_.Malloc(GetBlockSize(capacity));
+                    if (block == nullptr) {
+                        Trim();
+                        block = mem_.Malloc(GetBlockSize(capacity));
+                    }
+                    if (block == nullptr) {
+                        alloc_failure_count_.fetch_add(1, std::memory_order_relaxed);
+                        throw std::bad_alloc();
+                    }
+
+                    header           = new (block) TxBufferHeader;
+                    header->capacity = capacity;
+                    header->recycler = this;
+                }
+
+                header->ref_count.store(1, std::memory_order_relaxed);
+                header->length    = length;
+                header->next_free = nullptr;
+                return header;
+            }
+
+            static std::size_t GetSizeClass(std::size_t length)
+            {
+                std::size_t size_class = 0;
+                while (size_class < kClassCount && kClassSizes[size_class] < length) {
+                    size_class++;
+                }
+                return size_class;
+            }
+
+            static std::size_t GetBlockSize(std::size_t capacity)
+            {
+                return sizeof(TxBufferHeader) + capacity;
+            }
+
+            void Free(TxBufferHeader *header)
+            {
+                auto size = GetBlockSize(header->capacity);
+                header->~TxBufferHeader();
+                mem_.Free(header, size);
+            }
+        };
+    }
+}
@@ -0,0 +1,14 @@
+#include "rpc_engine.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        void RpcEngine::Start()
+        {
+            framer_.StartReceiving([this](const uint8_t *packet, std::size_t length) {
+                endpoint_.OnPacket(packet, length);
+            });
+        }
+    }
+}
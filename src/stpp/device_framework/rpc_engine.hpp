@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "byte_device.hpp"
+#include "cobs_framer.hpp"
+#include "tx_priority.hpp"
+#include "../freertos_lock.hpp"
+#include "../rpc.hpp"
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 让 stpp::rpc::Endpoint 通过 CobsFramer 收发数据包
+         * @note 包直接分配在设备的发送缓冲池中，回复原地写入、原地编码后发送
+         *
+         */
+        class CobsRpcTransport
+        {
+        public:
+            using Packet_t = CobsFramer::PacketBuffer;
+
+            explicit CobsRpcTransport(CobsFramer &framer, TxPriority priority = TxPriority::kNormal)
+                : framer_(&framer), priority_(priority) {};
+
+            Packet_t AllocatePacket(std::size_t max_length)
+            {
+                return framer_->AllocatePacket(max_length);
+            }
+
+            bool SendPacket(Packet_t &&packet, std::size_t length)
+            {
+                return framer_->AsyncSendPacket(std::move(packet), length, device_framework_internal::CallbackFunc_t(), nullptr, priority_);
+            }
+
+        private:
+            CobsFramer *framer_;
+            TxPriority priority_;
+        };
+
+        /**
+         * @brief ByteDevice 上的请求/响应 RPC。用方法 id 注册处理函数，用序号区分同时进行的多个调用，调用可以流水线发送
+         * @note 包格式见 stpp::rpc::Endpoint，包之间用 COBS 分隔。只能用于已开启流式接收的设备，Start() 之后会占用设备的新数据回调
+         * @note 处理函数直接读取接收环形缓冲区中解码后的参数，回复直接写入发送缓冲区，两个方向都没有中间复制。
+         *       处理函数和结果回调在设备的新数据回调中执行，执行上下文取决于设备的打开方式
+         *
+         */
+        class RpcEngine
+        {
+        public:
+            using Endpoint_t           = stpp::rpc::Endpoint<CobsRpcTransport, stpp::CriticalSection>;
+            using Handler_t            = Endpoint_t::Handler_t;
+            using ResultCallbackFunc_t = Endpoint_t::ResultCallbackFunc_t;
+
+            /**
+             * @param device 收发数据的设备
+             * @param max_packet_length 包的最大长度，包括 5 字节的包头和 2 字节的 CRC，单位字节
+             * @param max_methods 可注册的方法 id 为 0 到 max_methods - 1
+             * @param max_pending_calls 同时进行的调用数的上限
+             * @param priority 请求和回复的发送优先级
+             */
+            RpcEngine(ByteDevice &device, std::size_t max_packet_length, std::size_t max_methods, std::size_t max_pending_calls, TxPriority priority = TxPriority::kNormal)
+                : framer_(device, max_packet_length), endpoint_(CobsRpcTransport(framer_, priority), max_packet_length, max_methods, max_pending_calls) {};
+
+            RpcEngine(RpcEngine &&)                 = delete;
+            RpcEngine(const RpcEngine &)            = delete;
+            RpcEngine &operator=(RpcEngine &&)      = delete;
+            RpcEngine &operator=(const RpcEngine &) = delete;
+
+            /**
+             * @brief 注册方法的处理函数。应在 Start() 之前调用
+             *
+             * @return false method_id 超出范围
+             */
+            bool Register(uint8_t method_id, Handler_t handler)
+            {
+                return endpoint_.Register(method_id, std::move(handler));
+            }
+
+            /**
+             * @brief 开始接收请求和回复
+             *
+             */
+            void Start();
+
+            /**
+             * @brief 调用对端的方法，不会阻塞。可以在中断上下文中调用
+             *
+             * @param write_args 以 void(stpp::rpc::Writer &) 的形式把参数直接写入发送缓冲区
+             * @param callback 收到回复时调用，result 只在回调期间有效
+             * @param seq 不为空时保存调用的序号，可用于取消调用
+             * @return true 请求已发送
+             * @return false 进行中的调用过多、参数过长或内存不足，回调函数不会被调用
+             */
+            template <typename F, typename = std::enable_if_t<std::is_invocable_v<F &, stpp::rpc::Writer &>>>
+            bool AsyncCall(uint8_t method_id, F &&write_args, ResultCallbackFunc_t callback, uint16_t *seq = nullptr)
+            {
+                return endpoint_.AsyncCall(method_id, std::forward<F>(write_args), std::move(callback), seq);
+            }
+
+            bool AsyncCall(uint8_t method_id, const void *args, std::size_t length, ResultCallbackFunc_t callback, uint16_t *seq = nullptr)
+            {
+                return endpoint_.AsyncCall(method_id, args, length, std::move(callback), seq);
+            }
+
+            /**
+             * @brief 放弃等待一个调用，以 Status::kCancelled 调用其回调函数，之后收到的回复被丢弃。对端没有回复时用于超时处理
+             *
+             * @return false 调用不存在或已完成
+             */
+            bool Cancel(uint16_t seq)
+            {
+                return endpoint_.Cancel(seq);
+            }
+
+            std::size_t GetPendingCount()
+            {
+                return endpoint_.GetPendingCount();
+            }
+
+            /**
+             * @brief 因 CRC 错误、格式错误、超长或内存不足而丢弃的包数
+             *
+             */
+            uint32_t GetErrorCount() const
+            {
+                return endpoint_.GetErrorCount() + framer_.GetRxErrorCount();
+            }
+
+        private:
+            CobsFramer framer_;
+            Endpoint_t endpoint_;
+        };
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 指向接收环形缓冲区的只读视图，不拷贝数据
+         * @note 数据在缓冲区末尾回绕时分为两段：先 first，再 second。不回绕时 second_length 为 0
+         *
+         */
+        struct RxView {
+            const uint8_t *first      = nullptr;
+            std::size_t first_length  = 0;
+            const uint8_t *second     = nullptr;
+            std::size_t second_length = 0;
+
+            std::size_t GetSize() const
+            {
+                return first_length + second_length;
+            }
+
+            bool IsEmpty() const
+            {
+                return GetSize() == 0;
+            }
+
+            /**
+             * @brief 第 index 个字节，index 必须小于 GetSize()
+             *
+             */
+            uint8_t operator[](std::size_t index) const
+            {
+                return index < first_length ? first[index] : second[index - first_length];
+            }
+
+            /**
+             * @brief 把从 offset 开始的 length 个字节复制到 data，用于取出跨越回绕处的字段
+             *
+             * @return std::size_t 实际复制的字节数
+             */
+            std::size_t CopyTo(void *data, std::size_t length, std::size_t offset = 0) const
+            {
+                if (offset >= GetSize()) {
+                    return 0;
+                }
+                if (length > GetSize() - offset) {
+                    length = GetSize() - offset;
+                }
+
+                auto dst           = static_cast<uint8_t *>(data);
+                std::size_t copied = 0;
+                if (offset < first_length) {
+                    copied = first_length - offset < length ? first_length - offset : length;
+                    std::memcpy(dst, first + offset, copied);
+                    offset = first_length;
+                }
+                std::memcpy(dst + copied, second + (offset - first_length), length - copied);
+                return length;
+            }
+        };
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace stpp
+{
+    namespace device_framework_internal
+    {
+        class TxBufferRecycler;
+
+        /**
+         * @brief TxBuffer 的头部，与数据放在同一块内存中，数据紧跟在头部之后
+         *
+         */
+        struct TxBufferHeader {
+            std::atomic<uint32_t> ref_count{1};
+            std::size_t capacity       = 0; // 数据区大小
+            std::size_t length         = 0; // 有效数据长度
+            TxBufferRecycler *recycler = nullptr;
+            TxBufferHeader *next_free  = nullptr; // 只在空闲链表中使用
+
+            void (*release_owner)(TxBufferHeader *header) = nullptr; // 数据区中存放的是接管的所有者对象时，回收前用它析构该对象
+
+            uint8_t *GetData()
+            {
+                return reinterpret_cast<uint8_t *>(this + 1);
+            }
+        };
+
+        /**
+         * @brief 回收引用计数归零的 TxBuffer
+         *
+         */
+        class TxBufferRecycler
+        {
+        public:
+            virtual void Recycle(TxBufferHeader *header) = 0;
+
+        protected:
+            ~TxBufferRecycler() = default;
+        };
+    }
+
+    namespace device
+    {
+        /**
+         * @brief 发送缓冲区的句柄。引用计数与数据放在同一块内存中，复制句柄不分配内存
+         * @note 最后一个句柄销毁时，缓冲区回到分配它的缓冲池
+         *
+         */
+        class TxBuffer
+        {
+            using Header_t = device_framework_internal::TxBufferHeader;
+
+        public:
+            TxBuffer() = default;
+
+            /**
+             * @brief 接管 header 的一个引用。由缓冲池调用
+             *
+             */
+            explicit TxBuffer(Header_t *header)
+                : header_(header) {};
+
+            TxBuffer(const TxBuffer &other)
+                : header_(other.header_)
+            {
+                if (header_ != nullptr) {
+                    header_->ref_count.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            TxBuffer(TxBuffer &&other) noexcept
+                : header_(other.header_)
+            {
+                other.header_ = nullptr;
+            }
+
+            TxBuffer &operator=(const TxBuffer &other)
+            {
+                if (this != &other) {
+                    Reset();
+                    header_ = other.header_;
+                    if (header_ != nullptr) {
+                        header_->ref_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                return *this;
+            }
+
+            TxBuffer &operator=(TxBuffer &&other) noexcept
+            {
+                if (this != &other) {
+                    Reset();
+                    header_       = other.header_;
+                    other.header_ = nullptr;
+                }
+                return *this;
+            }
+
+            ~TxBuffer()
+            {
+                Reset();
+            }
+
+            uint8_t *GetData() const
+            {
+                return header_ == nullptr ? nullptr : header_->GetData();
+            }
+
+            std::size_t GetLength() const
+            {
+                return header_ == nullptr ? 0 : header_->length;
+            }
+
+            std::size_t GetCapacity() const
+            {
+                return header_ == nullptr ? 0 : header_->capacity;
+            }
+
+            /**
+             * @brief 设置有效数据长度，超过容量时截断为容量
+             *
+             */
+            void SetLength(std::size_t length)
+            {
+                if (header_ != nullptr) {
+                    header_->length = length < header_->capacity ? length : header_->capacity;
+                }
+            }
+
+            explicit operator bool() const
+            {
+                return header_ != nullptr;
+            }
+
+            /**
+             * @brief 放弃引用。最后一个引用放弃时，缓冲区回到缓冲池
+             *
+             */
+            void Reset()
+            {
+                if (header_ != nullptr && header_->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    header_->recycler->Recycle(header_);
+                }
+                header_ = nullptr;
+            }
+
+        private:
+            Header_t *header_ = nullptr;
+        };
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stpp
+{
+    namespace device
+    {
+        /**
+         * @brief 写请求的优先级。每个优先级有自己的发送队列，总是先发送优先级最高的非空队列
+         *
+         */
+        enum class TxPriority : uint8_t {
+            kLow    = 0,
+            kNormal = 1,
+            kHigh   = 2,
+        };
+
+        constexpr std::size_t kTxPriorityCount = 3;
+    }
+}
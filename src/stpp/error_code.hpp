@@ -3,7 +3,8 @@
 namespace stpp
 {
     enum class ErrorCode {
-        OK    = 0,
-        ERROR = 1
+        OK        = 0,
+        ERROR     = 1,
+        CANCELLED = 2, // 请求被取消
     };
 }
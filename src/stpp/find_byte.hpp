@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace stpp
+{
+    /**
+     * @brief Find the first occurrence of value in data, scanning a machine word at a time.
+     * @note The unaligned head and tail are scanned byte by byte, the aligned middle one word per step
+     *       with the classic "has zero byte" bit trick. Never reads outside [data, data + length).
+     *
+     * @return std::size_t Index of the first match, or length if value does not occur
+     */
+    inline std::size_t FindByte(const void *data, std::size_t length, uint8_t value)
+    {
+        using Word_t = uintptr_t;
+
+        constexpr Word_t kOnes  = ~static_cast<Word_t>(0) / 0xff; // 0x0101...01
+        constexpr Word_t kHighs = kOnes * 0x80;                  // 0x8080...80
+
+        auto bytes    = static_cast<const uint8_t *>(data);
+        std::size_t i = 0;
+
+        // Head: advance byte by byte until bytes + i is word-aligned
+        while (i < length && (reinterpret_cast<uintptr_t>(bytes + i) % sizeof(Word_t)) != 0) {
+            if (bytes[i] == value) {
+                return i;
+            }
+            i++;
+        }
+
+        // Middle: a byte of word equals value exactly when the same byte of (word ^ pattern) is zero
+        auto pattern = kOnes * value;
+        for (; i + sizeof(Word_t) <= length; i += sizeof(Word_t)) {
+            Word_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            word ^= pattern;
+            if (((word - kOnes) & ~word & kHighs) != 0) {
+                break; // The match is somewhere in this word, let the tail loop pin it down
+            }
+        }
+
+        // Tail, and the word that contains the match
+        for (; i < length; i++) {
+            if (bytes[i] == value) {
+                return i;
+            }
+        }
+        return length;
+    }
+}
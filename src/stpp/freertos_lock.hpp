@@ -216,12 +216,18 @@ namespace stpp
 
         void lock_from_isr()
         {
-            interrupt_status_ = taskENTER_CRITICAL_FROM_ISR();
+            // 允许在中断中嵌套上锁，只有最外层保存并恢复中断状态
+            auto status = taskENTER_CRITICAL_FROM_ISR();
+            if (isr_nesting_++ == 0) {
+                interrupt_status_ = status;
+            }
         }
 
         void unlock_from_isr()
         {
-            taskEXIT_CRITICAL_FROM_ISR(interrupt_status_);
+            if (--isr_nesting_ == 0) {
+                taskEXIT_CRITICAL_FROM_ISR(interrupt_status_);
+            }
         }
 
         void lock()
@@ -244,6 +250,7 @@ namespace stpp
 
     private:
         uint32_t interrupt_status_;
+        uint32_t isr_nesting_ = 0;
     };
 
     class CriticalSectionFromThread
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace stpp
+{
+    template <typename Signature, std::size_t Capacity = 4 * sizeof(void *)>
+    class InplaceFunction;
+
+    /**
+     * @brief Fixed-capacity replacement for std::function that never allocates.
+     * @note The callable is stored inside the object. A callable larger than Capacity bytes fails to compile
+     *       instead of falling back to the heap, so it is safe to create and copy from an ISR.
+     * @note Like std::function, the stored callable must be copy-constructible.
+     */
+    template <typename R, typename... Args, std::size_t Capacity>
+    class InplaceFunction<R(Args...), Capacity>
+    {
+    public:
+        InplaceFunction() noexcept = default;
+
+        InplaceFunction(std::nullptr_t) noexcept {}
+
+        template <typename F,
+                  typename Fn = std::decay_t<F>,
+                  typename    = std::enable_if_t<!std::is_same_v<Fn, InplaceFunction> && std::is_invocable_r_v<R, Fn &, Args...>>>
+        InplaceFunction(F &&f)
+        {
+            static_assert(sizeof(Fn) <= Capacity, "Callable is too large for this InplaceFunction, reduce the captures or raise Capacity");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable is over-aligned for InplaceFunction");
+            static_assert(std::is_copy_constructible_v<Fn>, "InplaceFunction requires a copy-constructible callable");
+
+            // A null function pointer makes an empty InplaceFunction. Check a decayed copy: F may be a reference
+            // to a function, which is never null
+            if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn>) {
+                Fn pointer = f;
+                if (pointer == nullptr) {
+                    return;
+                }
+            }
+
+            new (&storage_) Fn(std::forward<F>(f));
+            invoke_ = &Invoke<Fn>;
+            manage_ = &Manage<Fn>;
+        }
+
+        InplaceFunction(const InplaceFunction &other)
+        {
+            CopyFrom(other);
+        }
+
+        InplaceFunction(InplaceFunction &&other) noexcept
+        {
+            MoveFrom(other);
+        }
+
+        InplaceFunction &operator=(const InplaceFunction &other)
+        {
+            if (this != &other) {
+                Reset();
+                CopyFrom(other);
+            }
+            return *this;
+        }
+
+        InplaceFunction &operator=(InplaceFunction &&other) noexcept
+        {
+            if (this != &other) {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+
+        InplaceFunction &operator=(std::nullptr_t) noexcept
+        {
+            Reset();
+            return *this;
+        }
+
+        ~InplaceFunction()
+        {
+            Reset();
+        }
+
+        /**
+         * @brief Call the stored callable
+         * @note Throws std::bad_function_call if empty, same as std::function
+         */
+        R operator()(Args... args) const
+        {
+            if (invoke_ == nullptr) {
+                throw std::bad_function_call();
+            }
+            return invoke_(const_cast<void *>(static_cast<const void *>(&storage_)), std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return invoke_ != nullptr;
+        }
+
+        /**
+         * @brief Destroy the stored callable and leave the function empty
+         *
+         */
+        void Reset() noexcept
+        {
+            if (manage_ != nullptr) {
+                manage_(Operation::kDestroy, &storage_, nullptr);
+            }
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+
+    private:
+        enum class Operation {
+            kCopy,
+            kMove,
+            kDestroy,
+        };
+
+        using Invoker_t = R (*)(void *, Args &&...);
+        using Manager_t = void (*)(Operation, void *dst, void *src);
+
+        alignas(std::max_align_t) unsigned char storage_[Capacity];
+        Invoker_t invoke_ = nullptr;
+        Manager_t manage_ = nullptr;
+
+        template <typename Fn>
+        static R Invoke(void *storage, Args &&...args)
+        {
+            return std::invoke(*static_cast<Fn *>(storage), std::forward<Args>(args)...);
+        }
+
+        template <typename Fn>
+        static void Manage(Operation op, void *dst, void *src)
+        {
+            switch (op) {
+                case Operation::kCopy:
+                    new (dst) Fn(*static_cast<const Fn *>(src));
+                    break;
+                case Operation::kMove:
+                    new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+                    static_cast<Fn *>(src)->~Fn();
+                    break;
+                case Operation::kDestroy:
+                    static_cast<Fn *>(dst)->~Fn();
+                    break;
+            }
+        }
+
+        void CopyFrom(const InplaceFunction &other)
+        {
+            if (other.manage_ != nullptr) {
+                other.manage_(Operation::kCopy, &storage_, const_cast<unsigned char *>(other.storage_));
+            }
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+        }
+
+        void MoveFrom(InplaceFunction &other) noexcept
+        {
+            if (other.manage_ != nullptr) {
+                other.manage_(Operation::kMove, &storage_, &other.storage_);
+            }
+            invoke_       = other.invoke_;
+            manage_       = other.manage_;
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+        }
+    };
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace stpp
+{
+    /**
+     * @brief Fixed-capacity FIFO queue backed by a ring buffer.
+     * @note All storage is allocated once in the constructor. Push and pop never allocate and cost O(1).
+     * @note Not thread-safe. Guard it with a lock if it is shared between contexts.
+     */
+    template <typename T>
+    class RingQueue
+    {
+    public:
+        RingQueue(std::size_t capacity)
+            : capacity_(capacity), head_(0), size_(0)
+        {
+            buffer_ = new T[capacity];
+        }
+
+        RingQueue(RingQueue &&other)
+            : buffer_(other.buffer_), capacity_(other.capacity_), head_(other.head_), size_(other.size_)
+        {
+            other.buffer_   = nullptr;
+            other.capacity_ = 0;
+            other.head_     = 0;
+            other.size_     = 0;
+        }
+
+        RingQueue &operator=(RingQueue &&other)
+        {
+            if (this != &other) {
+                delete[] buffer_;
+                buffer_         = other.buffer_;
+                capacity_       = other.capacity_;
+                head_           = other.head_;
+                size_           = other.size_;
+                other.buffer_   = nullptr;
+                other.capacity_ = 0;
+                other.head_     = 0;
+                other.size_     = 0;
+            }
+            return *this;
+        }
+
+        RingQueue(const RingQueue &)            = delete;
+        RingQueue &operator=(const RingQueue &) = delete;
+
+        ~RingQueue()
+        {
+            delete[] buffer_;
+        }
+
+        /**
+         * @brief Get the max number of items that can be stored in the queue
+         *
+         * @return std::size_t
+         */
+        std::size_t GetCapacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+         * @brief Get the number of items in the queue
+         *
+         * @return std::size_t
+         */
+        std::size_t GetSize() const
+        {
+            return size_;
+        }
+
+        bool IsEmpty() const
+        {
+            return size_ == 0;
+        }
+
+        bool IsFull() const
+        {
+            return size_ == capacity_;
+        }
+
+        /**
+         * @brief Append an item to the back of the queue
+         *
+         * @return true The item was stored
+         * @return false The queue is full, the item is left untouched
+         */
+        bool PushBack(T &&item)
+        {
+            if (IsFull()) {
+                return false;
+            }
+
+            buffer_[Wrap(head_ + size_)] = std::move(item);
+            size_++;
+            return true;
+        }
+
+        bool PushBack(const T &item)
+        {
+            if (IsFull()) {
+                return false;
+            }
+
+            buffer_[Wrap(head_ + size_)] = item;
+            size_++;
+            return true;
+        }
+
+        /**
+         * @brief Insert an item at the front of the queue
+         *
+         * @return true The item was stored
+         * @return false The queue is full, the item is left untouched
+         */
+        bool PushFront(T &&item)
+        {
+            if (IsFull()) {
+                return false;
+            }
+
+            head_          = Wrap(head_ + capacity_ - 1);
+            buffer_[head_] = std::move(item);
+            size_++;
+            return true;
+        }
+
+        /**
+         * @brief Get the item at the front of the queue
+         * @note The queue must not be empty
+         */
+        T &Front()
+        {
+            return buffer_[head_];
+        }
+
+        /**
+         * @brief Move the front item out of the queue
+         *
+         * @param item The front item is moved here
+         * @return true Success
+         * @return false The queue is empty
+         */
+        bool PopFront(T &item)
+        {
+            if (IsEmpty()) {
+                return false;
+            }
+
+            item           = std::move(buffer_[head_]);
+            buffer_[head_] = T(); // Release whatever the moved-from slot may still hold
+            head_          = Wrap(head_ + 1);
+            size_--;
+            return true;
+        }
+
+        /**
+         * @brief Get the index-th item counted from the front of the queue
+         * @note index must be less than GetSize()
+         */
+        T &operator[](std::size_t index)
+        {
+            return buffer_[Wrap(head_ + index)];
+        }
+
+        /**
+         * @brief Remove the index-th item counted from the front of the queue, keeping the order of the rest
+         * @note index must be less than GetSize(). Costs O(n)
+         */
+        void Erase(std::size_t index)
+        {
+            for (std::size_t i = index; i + 1 < size_; i++) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+            (*this)[size_ - 1] = T();
+            size_--;
+        }
+
+        void Clear()
+        {
+            for (std::size_t i = 0; i < size_; i++) {
+                (*this)[i] = T();
+            }
+            head_ = 0;
+            size_ = 0;
+        }
+
+    private:
+        T *buffer_;
+        std::size_t capacity_;
+        std::size_t head_;
+        std::size_t size_;
+
+        std::size_t Wrap(std::size_t index) const
+        {
+            return index >= capacity_ ? index - capacity_ : index;
+        }
+    };
+}
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include "crc.hpp"
+#include "inplace_function.hpp"
+
+namespace stpp
+{
+    namespace rpc
+    {
+        /**
+         * @brief Outcome of a call, as seen by the caller
+         *
+         */
+        enum class Status : uint8_t {
+            kOk            = 0,
+            kUnknownMethod = 1, // The peer has no handler for the method id
+            kHandlerError  = 2, // The handler reported an error with Writer::SetError()
+            kReplyTooLong  = 3, // The reply did not fit in a packet
+            kCancelled     = 4, // Cancelled locally with Endpoint::Cancel()
+        };
+
+        /**
+         * @brief Read-only view of the arguments or the result of a call. Reads straight from the receive buffer.
+         * @note Scalars are stored in the byte order of the machine, which is little-endian on both Cortex-M and x86.
+         *       A read past the end returns false (or nullptr) and sets the error flag.
+         */
+        class Reader
+        {
+        public:
+            Reader(const uint8_t *data, std::size_t length)
+                : data_(data), length_(length) {};
+
+            template <typename T>
+            bool Read(T &value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read");
+
+                auto bytes = ReadBytes(sizeof(T));
+                if (bytes == nullptr) {
+                    return false;
+                }
+                std::memcpy(&value, bytes, sizeof(T));
+                return true;
+            }
+
+            template <typename T>
+            T Read()
+            {
+                T value{};
+                Read(value);
+                return value;
+            }
+
+            /**
+             * @brief Take the next length bytes without copying them
+             *
+             * @return const uint8_t* Points into the receive buffer and is only valid during the handler or callback.
+             *         nullptr if fewer than length bytes are left
+             */
+            const uint8_t *ReadBytes(std::size_t length)
+            {
+                if (length > GetRemaining()) {
+                    has_error_ = true;
+                    return nullptr;
+                }
+
+                auto bytes = data_ + position_;
+                position_ += length;
+                return bytes;
+            }
+
+            const uint8_t *GetData() const
+            {
+                return data_;
+            }
+
+            std::size_t GetLength() const
+            {
+                return length_;
+            }
+
+            std::size_t GetRemaining() const
+            {
+                return length_ - position_;
+            }
+
+            bool HasError() const
+            {
+                return has_error_;
+            }
+
+        private:
+            const uint8_t *data_;
+            std::size_t length_;
+            std::size_t position_ = 0;
+            bool has_error_       = false;
+        };
+
+        /**
+         * @brief Serializes the arguments or the reply of a call straight into the outgoing packet
+         * @note A write that does not fit returns false (or nullptr) and sets the error flag
+         */
+        class Writer
+        {
+        public:
+            Writer(uint8_t *data, std::size_t capacity)
+                : data_(data), capacity_(capacity) {};
+
+            template <typename T>
+            bool Write(const T &value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written");
+                return WriteBytes(&value, sizeof(T));
+            }
+
+            bool WriteBytes(const void *data, std::size_t length)
+            {
+                auto bytes = Reserve(length);
+                if (bytes == nullptr) {
+                    return false;
+                }
+                if (length != 0) {
+                    std::memcpy(bytes, data, length);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Reserve length bytes to be filled in place, e.g. by a sensor driver reading into the packet
+             *
+             * @return uint8_t* nullptr if the packet is full
+             */
+            uint8_t *Reserve(std::size_t length)
+            {
+                if (length > capacity_ - length_) {
+                    has_error_ = true;
+                    return nullptr;
+                }
+
+                auto bytes = data_ + length_;
+                length_ += length;
+                return bytes;
+            }
+
+            /**
+             * @brief Report a failure to the caller instead of the written reply. Only meaningful in a handler
+             *
+             */
+            void SetError()
+            {
+                is_failed_ = true;
+            }
+
+            std::size_t GetLength() const
+            {
+                return length_;
+            }
+
+            std::size_t GetCapacity() const
+            {
+                return capacity_;
+            }
+
+            bool HasError() const
+            {
+                return has_error_;
+            }
+
+        private:
+            template <typename Transport_t, typename Lock_t>
+            friend class Endpoint;
+
+            uint8_t *data_;
+            std::size_t capacity_;
+            std::size_t length_ = 0;
+            bool has_error_     = false;
+            bool is_failed_     = false;
+        };
+
+        /**
+         * @brief Lock for an Endpoint that is only used from one thread, e.g. on the host
+         *
+         */
+        struct NullLock {
+            void lock() {}
+            void unlock() {}
+        };
+
+        /**
+         * @brief Request/response RPC engine. Each end registers handlers by method id and calls the other end's methods.
+         * @note Every call carries a sequence number, so many calls can be in flight at once and answered in any order.
+         *       Handlers read their arguments in place from the receive buffer and write the reply in place into
+         *       the transmit buffer, there is no intermediate copy in either direction.
+         * @note Packet layout: type (1), method id (1), sequence number (2), status (1), payload, CRC-16 (2).
+         *       Packets with a bad CRC or a truncated header are dropped and counted in GetErrorCount().
+         *
+         * @tparam Transport_t Delivers whole packets. Must provide
+         *         Packet_t AllocatePacket(std::size_t max_length), where Packet_t is movable and has uint8_t *data
+         *         (nullptr on failure), and bool SendPacket(Packet_t &&packet, std::size_t length).
+         *         Received packets are passed to OnPacket()
+         * @tparam Lock_t Guards the table of outstanding calls, which is touched both by callers and by OnPacket()
+         */
+        template <typename Transport_t, typename Lock_t = NullLock>
+        class Endpoint
+        {
+        public:
+            using Handler_t            = stpp::InplaceFunction<void(Reader &args, Writer &reply)>;
+            using ResultCallbackFunc_t = stpp::InplaceFunction<void(Status status, Reader &result)>;
+
+            static constexpr std::size_t kHeaderLength = 5;
+            static constexpr std::size_t kCrcLength    = 2;
+
+            /**
+             * @param transport Moved into the endpoint
+             * @param max_packet_length Max packet length the transport can carry, header and CRC included
+             * @param max_methods Method ids from 0 to max_methods - 1 can be registered
+             * @param max_pending_calls Max number of outstanding calls
+             */
+            Endpoint(Transport_t transport, std::size_t max_packet_length, std::size_t max_methods, std::size_t max_pending_calls)
+                : transport_(std::move(transport)), max_packet_length_(max_packet_length), max_methods_(max_methods), max_pending_calls_(max_pending_calls)
+            {
+                handlers_ = new Handler_t[max_methods];
+                pending_  = new PendingCall[max_pending_calls];
+            }
+
+            Endpoint(const Endpoint &)            = delete;
+            Endpoint &operator=(const Endpoint &) = delete;
+
+            ~Endpoint()
+            {
+                delete[] handlers_;
+                delete[] pending_;
+            }
+
+            /**
+             * @brief Register the handler of a method. Must not race with OnPacket()
+             *
+             */
+            bool Register(uint8_t method_id, Handler_t handler)
+            {
+                if (method_id >= max_methods_) {
+                    return false;
+                }
+                handlers_[method_id] = std::move(handler);
+                return true;
+            }
+
+            /**
+             * @brief Call a method of the peer, serializing the arguments in place with write_args(Writer &)
+             *
+             * @param callback Called with the result when the reply arrives. result is only valid during the call
+             * @param seq If not null, receives the sequence number of the call for Cancel()
+             * @return true The request was sent
+             * @return false Too many outstanding calls, the arguments did not fit, or the transport failed.
+             *         callback will not be called
+             */
+            template <typename F, typename = std::enable_if_t<std::is_invocable_v<F &, Writer &>>>
+            bool AsyncCall(uint8_t method_id, F &&write_args, ResultCallbackFunc_t callback, uint16_t *seq = nullptr)
+            {
+                uint16_t call_seq;
+                if (!AddPending(std::move(callback), call_seq)) {
+                    return false;
+                }
+
+                auto is_sent = SendPacket(kTypeRequest, method_id, call_seq, Status::kOk, [&](Writer &writer) {
+                    write_args(writer);
+                    return !writer.HasError();
+                });
+                if (!is_sent) {
+                    TakePending(call_seq);
+                    return false;
+                }
+
+                if (seq != nullptr) {
+                    *seq = call_seq;
+                }
+                return true;
+            }
+
+            bool AsyncCall(uint8_t method_id, const void *args, std::size_t length, ResultCallbackFunc_t callback, uint16_t *seq = nullptr)
+            {
+                return AsyncCall(
+                    method_id, [&](Writer &writer) { writer.WriteBytes(args, length); }, std::move(callback), seq);
+            }
+
+            /**
+             * @brief Give up waiting for a call. Its callback is called with Status::kCancelled, a late reply is dropped
+             *
+             * @return false The call is not outstanding
+             */
+            bool Cancel(uint16_t seq)
+            {
+                ResultCallbackFunc_t callback;
+                if (!TakePending(seq, &callback)) {
+                    return false;
+                }
+
+                Reader empty(nullptr, 0);
+                if (callback) {
+                    callback(Status::kCancelled, empty);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Handle a received packet: run the handler of a request and send its reply, or complete a call
+             *
+             */
+            void OnPacket(const uint8_t *packet, std::size_t length)
+            {
+                if (length < kHeaderLength + kCrcLength) {
+                    error_count_++;
+                    return;
+                }
+
+                auto body_length = length - kCrcLength;
+                uint16_t crc;
+                std::memcpy(&crc, packet + body_length, sizeof(crc));
+                if (crc != stpp::crc::Crc16::Compute(packet, body_length)) {
+                    error_count_++;
+                    return;
+                }
+
+                auto type      = packet[0];
+                auto method_id = packet[1];
+                uint16_t seq;
+                std::memcpy(&seq, packet + 2, sizeof(seq));
+                auto status = static_cast<Status>(packet[4]);
+                Reader payload(packet + kHeaderLength, body_length - kHeaderLength);
+
+                if (type == kTypeRequest) {
+                    HandleRequest(method_id, seq, payload);
+                } else if (type == kTypeResponse) {
+                    ResultCallbackFunc_t callback;
+                    if (!TakePending(seq, &callback)) {
+                        return; // Cancelled, or a reply to an earlier session
+                    }
+                    if (callback) {
+                        callback(status, payload);
+                    }
+                } else {
+                    error_count_++;
+                }
+            }
+
+            /**
+             * @brief Number of outstanding calls
+             *
+             */
+            std::size_t GetPendingCount()
+            {
+                std::lock_guard lock(lock_);
+                return pending_count_;
+            }
+
+            /**
+             * @brief Number of dropped packets: bad CRC, truncated, unknown type, or no memory for a reply
+             *
+             */
+            uint32_t GetErrorCount() const
+            {
+                return error_count_;
+            }
+
+            Transport_t &GetTransport()
+            {
+                return transport_;
+            }
+
+        private:
+            static constexpr uint8_t kTypeRequest  = 0;
+            static constexpr uint8_t kTypeResponse = 1;
+
+            struct PendingCall {
+                uint16_t seq   = 0;
+                bool is_used   = false;
+                ResultCallbackFunc_t callback;
+            };
+
+            Transport_t transport_;
+            std::size_t max_packet_length_;
+            std::size_t max_methods_;
+            std::size_t max_pending_calls_;
+            Handler_t *handlers_;
+            PendingCall *pending_;
+            std::size_t pending_count_ = 0;
+            uint16_t next_seq_         = 0;
+            uint32_t error_count_      = 0;
+            Lock_t lock_;
+
+            bool AddPending(ResultCallbackFunc_t &&callback, uint16_t &seq)
+            {
+                std::lock_guard lock(lock_);
+                for (std::size_t i = 0; i < max_pending_calls_; i++) {
+                    if (!pending_[i].is_used) {
+                        seq                  = next_seq_++;
+                        pending_[i].seq      = seq;
+                        pending_[i].is_used  = true;
+                        pending_[i].callback = std::move(callback);
+                        pending_count_++;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool TakePending(uint16_t seq, ResultCallbackFunc_t *callback = nullptr)
+            {
+                std::lock_guard lock(lock_);
+                for (std::size_t i = 0; i < max_pending_calls_; i++) {
+                    if (pending_[i].is_used && pending_[i].seq == seq) {
+                        if (callback != nullptr) {
+                            *callback = std::move(pending_[i].callback);
+                        }
+                        pending_[i].callback = nullptr;
+                        pending_[i].is_used  = false;
+                        pending_count_--;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void HandleRequest(uint8_t method_id, uint16_t seq, Reader &args)
+            {
+                if (method_id >= max_methods_ || !handlers_[method_id]) {
+                    SendPacket(kTypeResponse, method_id, seq, Status::kUnknownMethod, [](Writer &) { return true; });
+                    return;
+                }
+
+                auto is_sent = SendPacket(kTypeResponse, method_id, seq, Status::kOk, [&](Writer &reply) {
+                    handlers_[method_id](args, reply);
+                    return true;
+                });
+                if (!is_sent) {
+                    error_count_++; // No memory for the reply, the caller will have to time out
+                }
+            }
+
+            /**
+             * @brief Build a packet in place and send it
+             *
+             * @param fill Writes the payload, returns false to abort the packet. For replies, a Writer error or
+             *        Writer::SetError() turns the packet into an empty reply with the matching status
+             */
+            template <typename F>
+            bool SendPacket(uint8_t type, uint8_t method_id, uint16_t seq, Status status, F &&fill)
+            {
+                auto packet = transport_.AllocatePacket(max_packet_length_);
+                if (packet.data == nullptr) {
+                    return false;
+                }
+
+                auto data = packet.data;
+                Writer writer(data + kHeaderLength, max_packet_length_ - kHeaderLength - kCrcLength);
+                if (!fill(writer)) {
+                    return false;
+                }
+
+                if (type == kTypeResponse && status == Status::kOk && (writer.HasError() || writer.is_failed_)) {
+                    status         = writer.HasError() ? Status::kReplyTooLong : Status::kHandlerError;
+                    writer.length_ = 0;
+                }
+
+                data[0] = type;
+                data[1] = method_id;
+                std::memcpy(data + 2, &seq, sizeof(seq));
+                data[4] = static_cast<uint8_t>(status);
+
+                auto body_length = kHeaderLength + writer.GetLength();
+                uint16_t crc     = stpp::crc::Crc16::Compute(data, body_length);
+                std::memcpy(data + body_length, &crc, sizeof(crc));
+
+                return transport_.SendPacket(std::move(packet), body_length + kCrcLength);
+            }
+        };
+    }
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Convert a stpp I/O trace dump to Chrome / Perfetto trace JSON.
+
+The input is the raw stpp_io_trace buffer, either sent by
+stpp::device::io_trace::Dump() or read from memory with a debugger:
+
+    (gdb) dump binary memory trace.bin &stpp_io_trace ((char *)&stpp_io_trace) + sizeof(stpp_io_trace)
+
+Usage:
+
+    python3 io_trace_to_chrome.py trace.bin -o trace.json
+
+Open the output in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x54505453
+HEADER = struct.Struct("<IHHIIIB3x")  # magic, version, event_size, capacity, clock_hz, head, is_enabled
+EVENT = struct.Struct("<IIHBB")  # timestamp, request_id, length, device_id, type
+
+BATCH_ID = 0xFFFFFFFF
+
+TX_ENQUEUE, RX_ENQUEUE, DISPATCH, TX_START, RX_START, TX_IRQ, RX_IRQ, \
+    TX_CB_BEGIN, TX_CB_END, RX_CB_BEGIN, RX_CB_END = range(1, 12)
+
+ERROR_CODES = {0: "OK", 1: "ERROR", 2: "CANCELLED"}
+
+TID_DISPATCH, TID_TX, TID_RX, TID_CALLBACK = 0, 1, 2, 3
+THREAD_NAMES = {TID_DISPATCH: "dispatch", TID_TX: "tx wire", TID_RX: "rx wire", TID_CALLBACK: "callbacks"}
+
+
+def read_events(data):
+    """Parse the dump and return (clock_hz, events) with events in recording order."""
+    if len(data) < HEADER.size:
+        sys.exit("dump is too short")
+
+    magic, version, event_size, capacity, clock_hz, head, _ = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("bad magic 0x%08x, not a stpp_io_trace dump" % magic)
+    if version != 1 or event_size != EVENT.size:
+        sys.exit("unsupported dump version %d / event size %d" % (version, event_size))
+    if len(data) < HEADER.size + capacity * event_size:
+        sys.exit("dump is truncated: expected %d events" % capacity)
+
+    if head <= capacity:
+        order = range(head)
+    else:
+        first = head % capacity
+        order = list(range(first, capacity)) + list(range(first))
+
+    events = []
+    for index in order:
+        events.append(EVENT.unpack_from(data, HEADER.size + index * event_size))
+    return clock_hz, events
+
+
+def unwrap(events, clock_hz):
+    """Turn the wrapping 32-bit timestamps into microseconds from the first event."""
+    scale = 1e6 / clock_hz if clock_hz else 1.0
+    result = []
+    total = 0
+    last = None
+    for timestamp, request_id, length, device_id, event_type in events:
+        if last is not None:
+            total += (timestamp - last) & 0xFFFFFFFF
+        last = timestamp
+        result.append((total * scale, request_id, length, device_id, event_type))
+    return result
+
+
+def convert(events):
+    trace = []
+    devices = set()
+    open_transfers = {}  # (device, tid) -> (ts, request_id, length)
+
+    def emit(**kwargs):
+        trace.append(kwargs)
+
+    for ts, request_id, length, device_id, event_type in events:
+        pid = device_id
+        devices.add(pid)
+        async_id = "%d-%d" % (device_id, request_id)
+
+        if event_type in (TX_ENQUEUE, RX_ENQUEUE):
+            kind = "write" if event_type == TX_ENQUEUE else "read"
+            emit(ph="b", cat=kind, name="%s #%d" % (kind, request_id), id=async_id, pid=pid, tid=TID_CALLBACK, ts=ts,
+                 args={"length": length})
+        elif event_type == DISPATCH:
+            emit(ph="i", s="t", name="dispatch", pid=pid, tid=TID_DISPATCH, ts=ts, args={"events": request_id})
+        elif event_type in (TX_START, RX_START):
+            tid = TID_TX if event_type == TX_START else TID_RX
+            open_transfers[(pid, tid)] = (ts, request_id, length)
+        elif event_type in (TX_IRQ, RX_IRQ):
+            tid = TID_TX if event_type == TX_IRQ else TID_RX
+            start = open_transfers.pop((pid, tid), None)
+            if start is not None:
+                start_ts, start_id, start_length = start
+                name = "batch" if start_id == BATCH_ID else "#%d" % start_id
+                emit(ph="X", name="%s %d B" % (name, start_length), pid=pid, tid=tid, ts=start_ts, dur=ts - start_ts,
+                     args={"result": ERROR_CODES.get(length, length)})
+            emit(ph="i", s="t", name="irq", pid=pid, tid=tid, ts=ts)
+        elif event_type in (TX_CB_BEGIN, RX_CB_BEGIN):
+            emit(ph="B", name="callback #%d" % request_id, pid=pid, tid=TID_CALLBACK, ts=ts,
+                 args={"result": ERROR_CODES.get(length, length)})
+        elif event_type in (TX_CB_END, RX_CB_END):
+            kind = "write" if event_type == TX_CB_END else "read"
+            emit(ph="E", pid=pid, tid=TID_CALLBACK, ts=ts)
+            emit(ph="e", cat=kind, name="%s #%d" % (kind, request_id), id=async_id, pid=pid, tid=TID_CALLBACK, ts=ts)
+        # Any other type is a torn event left by a write interrupted during Dump(), skip it
+
+    for pid in sorted(devices):
+        emit(ph="M", name="process_name", pid=pid, args={"name": "ByteDevice %d" % pid})
+        for tid, name in THREAD_NAMES.items():
+            emit(ph="M", name="thread_name", pid=pid, tid=tid, args={"name": name})
+
+    return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="raw stpp_io_trace dump")
+    parser.add_argument("-o", "--output", default="-", help="output JSON file, default stdout")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        clock_hz, events = read_events(f.read())
+
+    result = convert(unwrap(events, clock_hz))
+
+    if args.output == "-":
+        json.dump(result, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(result, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -8,6 +8,10 @@ extern "C" {
 #endif
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+void HAL_UART_AbortTransmitCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_AbortReceiveCpltCallback(UART_HandleTypeDef *huart);
 void MY_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
 #ifdef __cplusplus
 }
@@ -27,6 +31,34 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
     }
 }
 
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart->Instance == USART1) {
+        devices::Uart1->GetDriver()->HardwareRxEventCallback(Size);
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART1) {
+        devices::Uart1->GetDriver()->HardwareErrorCallback();
+    }
+}
+
+void HAL_UART_AbortTransmitCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART1) {
+        devices::Uart1->GetDriver()->HardwareTxAbortCallback();
+    }
+}
+
+void HAL_UART_AbortReceiveCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART1) {
+        devices::Uart1->GetDriver()->HardwareRxAbortCallback();
+    }
+}
+
 void MY_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
     // static int count         = 0;
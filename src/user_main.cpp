@@ -5,6 +5,7 @@
 #include <task.h>
 #include <usart.h>
 #include <devices/devices.hpp>
+#include <stpp/device_framework/line_reader.hpp>
 #include <stpp/thread_priority_def.h>
 #include <tim.h>
 #include <HighPrecisionTime/high_precision_time.h>
@@ -64,13 +65,16 @@ void StartDefaultTask(void const *argument)
 
     // CallbackFunc();
 
-    char read_buf[4] = {};
-    devices::Uart1->AsyncRead(read_buf, sizeof(read_buf) - 1, [&read_buf](stpp::ErrorCode) {
-        char str[20];
-        auto len = std::snprintf(str, sizeof(str), "AsyncRead: %s\n", read_buf);
-        devices::Uart1->AsyncWrite(str, len);
+    // 按行读取，换行符一到立即完成，不需要预先猜测长度
+    stpp::device::LineReader async_reader(*devices::Uart1, 32);
+    async_reader.AsyncReadLine([](stpp::ErrorCode, std::string_view line) {
+        devices::Uart1->AsyncWrite("AsyncReadLine: ");
+        devices::Uart1->AsyncWrite(line);
+        devices::Uart1->AsyncWrite("\n");
     });
 
+    stpp::device::LineReader line_reader(*devices::Uart1, 64);
+
     while (true) {
         HAL_GPIO_TogglePin(Led_GPIO_Port, Led_Pin);
 
@@ -80,9 +84,8 @@ void StartDefaultTask(void const *argument)
         devices::Uart1->SyncWrite("You can put any string here\n");
 
         auto callback_func = [](stpp::ErrorCode e) {
-            char str[40];
-            auto len = std::snprintf(str, sizeof(str), "AllocatedSize: %u\n", devices::Uart1->GetAllocatedSize());
-            devices::Uart1->AsyncWrite(str, len);
+            // 直接格式化到发送缓冲区中，不需要栈上的字符串
+            devices::Uart1->AsyncPrintf("AllocatedSize: %u\n", static_cast<unsigned>(devices::Uart1->GetAllocatedSize()));
             switch (e) {
                 case stpp::ErrorCode::OK:
                     devices::Uart1->AsyncWrite("AsyncWrite complete!\n");
@@ -99,11 +102,12 @@ void StartDefaultTask(void const *argument)
         devices::Uart1->AsyncWrite("AsyncWriting\n", callback_func);
         devices::Uart1->AsyncWriteNoCopy("AsyncWritingNoCopy\n", callback_func);
 
-        char read_buf2[4] = {};
-        devices::Uart1->SyncRead(read_buf2, sizeof(read_buf2) - 1); // sizeof(read_buf) - 1 保证最后一个字节一定是 \0
-        devices::Uart1->SyncWrite("SyncRead: ");
-        devices::Uart1->SyncWrite(read_buf2);
-        devices::Uart1->SyncWrite("\n");
+        std::string_view line;
+        if (line_reader.ReadLine(line)) {
+            devices::Uart1->SyncWrite("ReadLine: ");
+            devices::Uart1->SyncWrite(line);
+            devices::Uart1->SyncWrite("\n");
+        }
 
         // // HAL_UART_Transmit(&huart1, (const uint8_t *)str, std::strlen(str), HAL_MAX_DELAY);
         // uart->Write(str, 0, std::strlen(str), HAL_MAX_DELAY);
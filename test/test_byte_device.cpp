@@ -0,0 +1,113 @@
+#include "private/test_defs.hpp"
+#include <memory>
+#include <vector>
+#include <stpp/device_framework/byte_device.hpp>
+using namespace stpp::device;
+
+namespace
+{
+    // Records the transfers instead of starting DMA; Complete*() stands in for the completion interrupt
+    class FakeDriver : public stpp::driver::ByteDriver
+    {
+    public:
+        std::vector<std::size_t> writes;
+        std::vector<std::size_t> reads;
+
+        bool AsyncRead(uint8_t *, std::size_t length) override
+        {
+            reads.push_back(length);
+            return true;
+        }
+
+        bool AsyncWrite(const uint8_t *, std::size_t length) override
+        {
+            writes.push_back(length);
+            return true;
+        }
+
+        void HardwareTxCpltCallback() override
+        {
+            if (write_cplt_cb_) {
+                write_cplt_cb_(stpp::ErrorCode::OK);
+            }
+        }
+
+        void HardwareRxCpltCallback() override
+        {
+            if (read_cplt_cb_) {
+                read_cplt_cb_(stpp::ErrorCode::OK);
+            }
+        }
+    };
+}
+
+TEST(ByteDeviceTest, RequestsBeforeOpen)
+{
+    auto driver_ptr = std::make_unique<FakeDriver>();
+    auto driver     = driver_ptr.get();
+    ByteDevice device(std::move(driver_ptr));
+
+    // Before Open the completion callbacks are not installed, so requests are only queued
+    int tx_done = 0, rx_done = 0;
+    uint8_t rx[4];
+    EXPECT_EQ(device.AsyncWrite("abc", [&](stpp::ErrorCode ec) { tx_done += ec == stpp::ErrorCode::OK; }), true);
+    EXPECT_EQ(device.AsyncRead(rx, sizeof(rx), [&](stpp::ErrorCode ec) { rx_done += ec == stpp::ErrorCode::OK; }), true);
+    EXPECT_EQ(driver->writes.empty(), true);
+    EXPECT_EQ(driver->reads.empty(), true);
+
+    device.OpenWithoutDaemon();
+    EXPECT_EQ(driver->writes, (std::vector<std::size_t>{3}));
+    EXPECT_EQ(driver->reads, (std::vector<std::size_t>{4}));
+
+    driver->HardwareTxCpltCallback();
+    driver->HardwareRxCpltCallback();
+    EXPECT_EQ(tx_done, 1);
+    EXPECT_EQ(rx_done, 1);
+
+    // Once open, an idle device starts the transfer in the caller's context
+    EXPECT_EQ(device.AsyncWrite("de", [&](stpp::ErrorCode ec) { tx_done += ec == stpp::ErrorCode::OK; }), true);
+    EXPECT_EQ(driver->writes, (std::vector<std::size_t>{3, 2}));
+    driver->HardwareTxCpltCallback();
+    EXPECT_EQ(tx_done, 2);
+}
+
+TEST(ByteDeviceTest, EmptyWritesRejected)
+{
+    auto driver_ptr = std::make_unique<FakeDriver>();
+    auto driver     = driver_ptr.get();
+    ByteDevice device(std::move(driver_ptr));
+    device.OpenWithoutDaemon();
+
+    // Nothing to send: every write is refused instead of handing a zero-length or garbage fragment to the driver
+    uint8_t data[1]            = {};
+    IoVec empty[2]             = {{data, 0}, {nullptr, 0}};
+    ByteDevice::RequestId_t id = 1;
+    EXPECT_EQ(device.AsyncWrite(data, 0), false);
+    EXPECT_EQ(device.AsyncWrite(std::string_view()), false);
+    EXPECT_EQ(device.AsyncWriteNoCopy(data, 0), false);
+    EXPECT_EQ(device.AsyncWrite(std::vector<uint8_t>()), false);
+    EXPECT_EQ(device.AsyncWritev(empty, 2), false);
+    EXPECT_EQ(device.AsyncWritevNoCopy(empty, 2, nullptr, &id), false);
+    EXPECT_EQ(device.AsyncWritevNoCopy(empty, 0), false);
+    EXPECT_EQ(id, 1);
+    EXPECT_EQ(driver->writes.empty(), true);
+
+    // Empty fragments among non-empty ones are skipped
+    IoVec mixed[3] = {{nullptr, 0}, {data, 1}, {data, 0}};
+    EXPECT_EQ(device.AsyncWritevNoCopy(mixed, 3), true);
+    EXPECT_EQ(driver->writes, (std::vector<std::size_t>{1}));
+    driver->HardwareTxCpltCallback();
+
+    // A batch stops at an empty write
+    ByteDevice::BatchEntry batch[3] = {ByteDevice::BatchEntry::Write(data, 1), ByteDevice::BatchEntry::WriteNoCopy(data, 0),
+                                       ByteDevice::BatchEntry::Write(data, 1)};
+    EXPECT_EQ(device.SubmitBatch(batch), 1);
+    EXPECT_EQ(driver->writes, (std::vector<std::size_t>{1, 1}));
+    driver->HardwareTxCpltCallback();
+}
+
+void TestByteDevice()
+{
+    RequestsBeforeOpen();
+    EmptyWritesRejected();
+}
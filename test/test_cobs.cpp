@@ -0,0 +1,127 @@
+#include "private/test_defs.hpp"
+#include <cstring>
+#include <vector>
+#include <stpp/cobs.hpp>
+using namespace stpp;
+
+static std::vector<uint8_t> Encode(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> out(GetCobsMaxEncodedLength(data.size()));
+    out.resize(CobsEncode(data.data(), data.size(), out.data()));
+    return out;
+}
+
+static std::vector<std::vector<uint8_t>> Decode(CobsDecoder &decoder, const std::vector<uint8_t> &data, std::size_t step)
+{
+    std::vector<std::vector<uint8_t>> packets;
+    for (std::size_t i = 0; i < data.size(); i += step) {
+        auto n = data.size() - i < step ? data.size() - i : step;
+        decoder.Feed(data.data() + i, n, [&](const uint8_t *packet, std::size_t length) {
+            packets.emplace_back(packet, packet + length);
+        });
+    }
+    return packets;
+}
+
+TEST(CobsTest, KnownVectors)
+{
+    EXPECT_EQ(Encode({}), (std::vector<uint8_t>{0x01}));
+    EXPECT_EQ(Encode({0x00}), (std::vector<uint8_t>{0x01, 0x01}));
+    EXPECT_EQ(Encode({0x00, 0x00}), (std::vector<uint8_t>{0x01, 0x01, 0x01}));
+    EXPECT_EQ(Encode({0x11, 0x22, 0x00, 0x33}), (std::vector<uint8_t>{0x03, 0x11, 0x22, 0x02, 0x33}));
+    EXPECT_EQ(Encode({0x11, 0x00, 0x00, 0x00}), (std::vector<uint8_t>{0x02, 0x11, 0x01, 0x01, 0x01}));
+}
+
+TEST(CobsTest, LongRuns)
+{
+    // 254 non-zero bytes fit in one 0xff block with no trailing block
+    std::vector<uint8_t> data(254);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i + 1);
+    }
+    auto encoded = Encode(data);
+    EXPECT_EQ(encoded.size(), 255);
+    EXPECT_EQ(encoded[0], 0xff);
+
+    // 255 non-zero bytes need a second block
+    data.push_back(0xff);
+    encoded = Encode(data);
+    EXPECT_EQ(encoded.size(), 257);
+    EXPECT_EQ(encoded[255], 0x02);
+    EXPECT_EQ(encoded[256], 0xff);
+    EXPECT_EQ(encoded.size() <= GetCobsMaxEncodedLength(data.size()), true);
+}
+
+TEST(CobsTest, RoundTripAnyChunking)
+{
+    std::vector<std::vector<uint8_t>> packets = {{}, {0x00}, {0x01, 0x00, 0x02}, std::vector<uint8_t>(300, 0x55), std::vector<uint8_t>(300, 0x00)};
+    std::vector<uint8_t> mixed(600);
+    for (std::size_t i = 0; i < mixed.size(); i++) {
+        mixed[i] = static_cast<uint8_t>(i * 7 % 13); // A zero every 13 bytes
+    }
+    packets.push_back(mixed);
+
+    std::vector<uint8_t> stream;
+    for (auto &packet : packets) {
+        auto encoded = Encode(packet);
+        EXPECT_EQ(std::memchr(encoded.data(), 0, encoded.size()), nullptr);
+        stream.insert(stream.end(), encoded.begin(), encoded.end());
+        stream.push_back(0x00);
+    }
+
+    for (std::size_t step : {1, 3, 64, 10000}) {
+        CobsDecoder decoder(600);
+        auto decoded = Decode(decoder, stream, step);
+        EXPECT_EQ(decoded, packets);
+        EXPECT_EQ(decoder.GetErrorCount(), 0);
+    }
+}
+
+TEST(CobsTest, OverflowAndMalformed)
+{
+    CobsDecoder decoder(4);
+
+    // Too long, then a good packet
+    std::vector<uint8_t> stream = Encode({1, 2, 3, 4, 5});
+    stream.push_back(0x00);
+    auto good = Encode({9, 8});
+    stream.insert(stream.end(), good.begin(), good.end());
+    stream.push_back(0x00);
+
+    // Cut short by a delimiter inside a block, then empty frames, then a good packet
+    stream.insert(stream.end(), {0x05, 0x11, 0x00, 0x00, 0x00});
+    stream.insert(stream.end(), good.begin(), good.end());
+    stream.push_back(0x00);
+
+    auto decoded = Decode(decoder, stream, 2);
+    EXPECT_EQ(decoded.size(), 2);
+    EXPECT_EQ(decoded[0], (std::vector<uint8_t>{9, 8}));
+    EXPECT_EQ(decoded[1], (std::vector<uint8_t>{9, 8}));
+    EXPECT_EQ(decoder.GetErrorCount(), 2);
+}
+
+TEST(CobsTest, EncodeInPlace)
+{
+    std::vector<uint8_t> data(600);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i % 300 == 0 ? 0 : i); // Long runs and a few zeros
+    }
+    auto expected = Encode(data);
+
+    // The payload sits right after the worst-case overhead, the encoding starts at the front of the same buffer
+    auto offset = GetCobsMaxEncodedLength(data.size()) - data.size();
+    std::vector<uint8_t> buffer(offset + data.size());
+    std::memcpy(buffer.data() + offset, data.data(), data.size());
+    auto length = CobsEncode(buffer.data() + offset, data.size(), buffer.data());
+    buffer.resize(length);
+    EXPECT_EQ(buffer, expected);
+}
+
+void TestCobs()
+{
+    KnownVectors();
+    LongRuns();
+    RoundTripAnyChunking();
+    OverflowAndMalformed();
+    EncodeInPlace();
+}
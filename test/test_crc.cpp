@@ -0,0 +1,87 @@
+#include "private/test_defs.hpp"
+#include <cstring>
+#include <stpp/crc.hpp>
+using namespace stpp::crc;
+
+static const char kCheckInput[] = "123456789";
+
+template <typename Spec_t, std::size_t Slices>
+static void CheckSpec(uint32_t expected)
+{
+    auto value = SoftwareCrc<Spec_t, Slices>::Compute(kCheckInput, 9);
+    EXPECT_EQ(value, expected);
+}
+
+template <std::size_t Slices>
+static void CheckAllSpecs()
+{
+    CheckSpec<Crc8Spec, Slices>(0xf4);
+    CheckSpec<Crc16Spec, Slices>(0x29b1);
+    CheckSpec<Crc16ModbusSpec, Slices>(0x4b37);
+    CheckSpec<Crc32Spec, Slices>(0xcbf43926);
+    CheckSpec<Crc32Mpeg2Spec, Slices>(0x0376e6e7);
+}
+
+TEST(CrcTest, CheckValues)
+{
+    CheckAllSpecs<1>();
+    CheckAllSpecs<4>();
+    CheckAllSpecs<8>();
+}
+
+TEST(CrcTest, EmptyInput)
+{
+    EXPECT_EQ(Crc32::Compute(nullptr, 0), 0x00000000);
+    EXPECT_EQ(Crc16::Compute(nullptr, 0), 0xffff);
+}
+
+template <typename Spec_t>
+static void CheckKernelsAgree(const uint8_t *data, std::size_t length)
+{
+    auto expected = SoftwareCrc<Spec_t, 1>::Compute(data, length);
+    EXPECT_EQ((SoftwareCrc<Spec_t, 4>::Compute(data, length)), expected);
+    EXPECT_EQ((SoftwareCrc<Spec_t, 8>::Compute(data, length)), expected);
+
+    // Any split into two updates, at any alignment, gives the same result
+    for (std::size_t split = 0; split <= length; split++) {
+        SoftwareCrc<Spec_t, 8> crc;
+        crc.Update(data, split);
+        crc.Update(data + split, length - split);
+        EXPECT_EQ(crc.GetValue(), expected);
+    }
+}
+
+TEST(CrcTest, KernelsAndIncrementalUpdateAgree)
+{
+    uint8_t data[100];
+    uint32_t seed = 1;
+    for (auto &byte : data) {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(seed >> 16);
+    }
+
+    for (std::size_t offset = 0; offset < 8; offset++) {
+        CheckKernelsAgree<Crc8Spec>(data + offset, sizeof(data) - 8);
+        CheckKernelsAgree<Crc16Spec>(data + offset, sizeof(data) - 8);
+        CheckKernelsAgree<Crc16ModbusSpec>(data + offset, sizeof(data) - 8);
+        CheckKernelsAgree<Crc32Spec>(data + offset, sizeof(data) - 8);
+        CheckKernelsAgree<Crc32Mpeg2Spec>(data + offset, sizeof(data) - 8);
+    }
+}
+
+TEST(CrcTest, ResetStartsOver)
+{
+    Crc32 crc;
+    crc.Update("garbage", 7);
+    crc.Reset();
+    crc.Update(kCheckInput, 9);
+    EXPECT_EQ(crc.GetValue(), 0xcbf43926);
+}
+
+void TestCrc()
+{
+    CheckValues();
+    EmptyInput();
+    KernelsAndIncrementalUpdateAgree();
+    ResetStartsOver();
+}
@@ -0,0 +1,62 @@
+#include "private/test_defs.hpp"
+#include <cstring>
+#include <stpp/find_byte.hpp>
+using namespace stpp;
+
+TEST(FindByteTest, Empty)
+{
+    const uint8_t data[1] = {'\n'};
+    EXPECT_EQ(FindByte(data, 0, '\n'), 0);
+}
+
+TEST(FindByteTest, NotFound)
+{
+    const char str[] = "no delimiter in this string at all";
+    EXPECT_EQ(FindByte(str, std::strlen(str), '\n'), std::strlen(str));
+}
+
+TEST(FindByteTest, FindsFirstMatch)
+{
+    const char str[] = "$GPGGA,123519,4807.038,N*47\r\n$GPRMC\r\n";
+    EXPECT_EQ(FindByte(str, std::strlen(str), '\n'), 28);
+    EXPECT_EQ(FindByte(str, std::strlen(str), '$'), 0);
+    EXPECT_EQ(FindByte(str, std::strlen(str), '*'), 24);
+}
+
+TEST(FindByteTest, EveryPositionAndAlignment)
+{
+    uint8_t buffer[80];
+
+    // Cover matches in the unaligned head, inside aligned words and in the tail, for every start offset
+    for (std::size_t offset = 0; offset < 16; offset++) {
+        for (std::size_t length = 0; length + offset <= 64; length++) {
+            for (std::size_t pos = 0; pos <= length; pos++) {
+                std::memset(buffer, 'a', sizeof(buffer));
+                if (pos < length) {
+                    buffer[offset + pos] = '\n';
+                }
+                buffer[offset + length] = '\n'; // A match just past the end must not be seen
+                EXPECT_EQ(FindByte(buffer + offset, length, '\n'), pos);
+            }
+        }
+    }
+}
+
+TEST(FindByteTest, HighBytesAndZero)
+{
+    // 0x80 and 0x00 are the corner cases of the bit trick
+    const uint8_t data[] = {0x81, 0x80, 0x7f, 0xff, 0x01, 0x00, 0x80, 0xfe, 0x00, 0x80};
+    EXPECT_EQ(FindByte(data, sizeof(data), 0x00), 5);
+    EXPECT_EQ(FindByte(data, sizeof(data), 0x80), 1);
+    EXPECT_EQ(FindByte(data, sizeof(data), 0xfe), 7);
+    EXPECT_EQ(FindByte(data, sizeof(data), 0x02), sizeof(data));
+}
+
+void TestFindByte()
+{
+    Empty();
+    NotFound();
+    FindsFirstMatch();
+    EveryPositionAndAlignment();
+    HighBytesAndZero();
+}
@@ -0,0 +1,104 @@
+#include "private/test_defs.hpp"
+#include <memory>
+#include <stpp/inplace_function.hpp>
+using namespace stpp;
+
+static int AddOne(int x)
+{
+    return x + 1;
+}
+
+TEST(InplaceFunctionTest, Empty)
+{
+    InplaceFunction<void()> func;
+    EXPECT_EQ(static_cast<bool>(func), false);
+
+    InplaceFunction<void()> func_null(nullptr);
+    EXPECT_EQ(static_cast<bool>(func_null), false);
+
+    int (*null_ptr)(int) = nullptr;
+    InplaceFunction<int(int)> func_null_ptr(null_ptr);
+    EXPECT_EQ(static_cast<bool>(func_null_ptr), false);
+}
+
+TEST(InplaceFunctionTest, FunctionPointer)
+{
+    InplaceFunction<int(int)> func(AddOne);
+    EXPECT_EQ(static_cast<bool>(func), true);
+    EXPECT_EQ(func(1), 2);
+}
+
+TEST(InplaceFunctionTest, LambdaWithCapture)
+{
+    int counter = 0;
+    InplaceFunction<void(int)> func([&counter](int x) { counter += x; });
+    func(2);
+    func(3);
+    EXPECT_EQ(counter, 5);
+}
+
+TEST(InplaceFunctionTest, CopyAndMove)
+{
+    auto item = std::make_shared<int>(7);
+
+    InplaceFunction<int()> func1([item]() { return *item; });
+    EXPECT_EQ(item.use_count(), 2);
+
+    InplaceFunction<int()> func2(func1);
+    EXPECT_EQ(item.use_count(), 3);
+    EXPECT_EQ(func2(), 7);
+
+    InplaceFunction<int()> func3(std::move(func1));
+    EXPECT_EQ(item.use_count(), 3);
+    EXPECT_EQ(static_cast<bool>(func1), false);
+    EXPECT_EQ(func3(), 7);
+
+    func2 = func3;
+    EXPECT_EQ(item.use_count(), 3);
+
+    func2 = std::move(func3);
+    EXPECT_EQ(item.use_count(), 2);
+    EXPECT_EQ(static_cast<bool>(func3), false);
+    EXPECT_EQ(func2(), 7);
+}
+
+TEST(InplaceFunctionTest, ResetReleasesCapture)
+{
+    auto item = std::make_shared<int>(0);
+
+    InplaceFunction<void()> func([item]() {});
+    EXPECT_EQ(item.use_count(), 2);
+
+    func = nullptr;
+    EXPECT_EQ(item.use_count(), 1);
+    EXPECT_EQ(static_cast<bool>(func), false);
+
+    {
+        InplaceFunction<void()> scoped([item]() {});
+        EXPECT_EQ(item.use_count(), 2);
+    }
+    EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(InplaceFunctionTest, CallEmptyThrows)
+{
+    InplaceFunction<void()> func;
+
+    bool is_thrown = false;
+    try {
+        func();
+    } catch (const std::bad_function_call &) {
+        is_thrown = true;
+    }
+    EXPECT_EQ(is_thrown, true);
+}
+
+void TestInplaceFunction()
+{
+    Empty();
+    FunctionPointer();
+    LambdaWithCapture();
+    CopyAndMove();
+    ResetReleasesCapture();
+    CallEmptyThrows();
+}
@@ -0,0 +1,53 @@
+#include "private/test_defs.hpp"
+#include <initializer_list>
+#include <stpp/device_framework/io_stats.hpp>
+using namespace stpp::device;
+
+static void Add(LatencyHistogram &histogram, uint32_t ticks, uint32_t times = 1)
+{
+    histogram.buckets[LatencyHistogram::GetBucket(ticks)] += times;
+    histogram.count += times;
+    if (ticks > histogram.max) {
+        histogram.max = ticks;
+    }
+}
+
+TEST(LatencyHistogramTest, Bucket)
+{
+    EXPECT_EQ(LatencyHistogram::GetBucket(0), 0u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(1), 1u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(2), 2u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(3), 2u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(4), 3u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(1023), 10u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(1024), 11u);
+    EXPECT_EQ(LatencyHistogram::GetBucket(UINT32_MAX), LatencyHistogram::kBucketCount - 1);
+
+    // 每个值都小于所在桶的上界
+    for (uint32_t ticks : {0u, 1u, 5u, 100u, 65535u, 1u << 20}) {
+        EXPECT_EQ(ticks < LatencyHistogram::GetBucketUpperBound(LatencyHistogram::GetBucket(ticks)), true);
+    }
+}
+
+TEST(LatencyHistogramTest, Percentile)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetPercentile(50), 0u);
+
+    Add(histogram, 3, 90);   // 桶 [2, 4)
+    Add(histogram, 100, 9);  // 桶 [64, 128)
+    Add(histogram, 5000, 1); // 桶 [4096, 8192)
+
+    EXPECT_EQ(histogram.GetPercentile(0), 4u);
+    EXPECT_EQ(histogram.GetPercentile(50), 4u);
+    EXPECT_EQ(histogram.GetPercentile(90), 4u);
+    EXPECT_EQ(histogram.GetPercentile(91), 128u);
+    EXPECT_EQ(histogram.GetPercentile(99), 128u);
+    EXPECT_EQ(histogram.GetPercentile(100), 5000u); // 不超过 max
+}
+
+void TestLatencyHistogram()
+{
+    Bucket();
+    Percentile();
+}
@@ -4,4 +4,31 @@ void test_main()
 {
     extern void TestContinuousBuffer();
     TestContinuousBuffer();
+
+    extern void TestRingQueue();
+    TestRingQueue();
+
+    extern void TestInplaceFunction();
+    TestInplaceFunction();
+
+    extern void TestLatencyHistogram();
+    TestLatencyHistogram();
+
+    extern void TestFindByte();
+    TestFindByte();
+
+    extern void TestStreamRxRing();
+    TestStreamRxRing();
+
+    extern void TestCobs();
+    TestCobs();
+
+    extern void TestCrc();
+    TestCrc();
+
+    extern void TestRpc();
+    TestRpc();
+
+    extern void TestByteDevice();
+    TestByteDevice();
 }
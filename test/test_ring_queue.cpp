@@ -0,0 +1,163 @@
+#include "private/test_defs.hpp"
+#include <memory>
+#include <stpp/ring_queue.hpp>
+using namespace stpp;
+
+TEST(RingQueueTest, Construction)
+{
+    RingQueue<int> queue(4);
+    EXPECT_EQ(queue.GetCapacity(), 4);
+    EXPECT_EQ(queue.GetSize(), 0);
+    EXPECT_EQ(queue.IsEmpty(), true);
+    EXPECT_EQ(queue.IsFull(), false);
+}
+
+TEST(RingQueueTest, PushBackAndPopFront)
+{
+    RingQueue<int> queue(4);
+
+    EXPECT_EQ(queue.PushBack(1), true);
+    EXPECT_EQ(queue.PushBack(2), true);
+    EXPECT_EQ(queue.GetSize(), 2);
+    EXPECT_EQ(queue.Front(), 1);
+
+    int out = 0;
+    EXPECT_EQ(queue.PopFront(out), true);
+    EXPECT_EQ(out, 1);
+    EXPECT_EQ(queue.PopFront(out), true);
+    EXPECT_EQ(out, 2);
+    EXPECT_EQ(queue.PopFront(out), false);
+    EXPECT_EQ(queue.IsEmpty(), true);
+}
+
+TEST(RingQueueTest, PushBackOverflow)
+{
+    RingQueue<int> queue(3);
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(queue.PushBack(i), true);
+    }
+    EXPECT_EQ(queue.IsFull(), true);
+    EXPECT_EQ(queue.PushBack(3), false);
+    EXPECT_EQ(queue.GetSize(), 3);
+}
+
+TEST(RingQueueTest, WrapAround)
+{
+    RingQueue<int> queue(3);
+    int out = 0;
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(queue.PushBack(i), true);
+        EXPECT_EQ(queue.PushBack(i + 100), true);
+        EXPECT_EQ(queue[0], i);
+        EXPECT_EQ(queue[1], i + 100);
+        EXPECT_EQ(queue.PopFront(out), true);
+        EXPECT_EQ(out, i);
+        EXPECT_EQ(queue.PopFront(out), true);
+        EXPECT_EQ(out, i + 100);
+    }
+    EXPECT_EQ(queue.IsEmpty(), true);
+}
+
+TEST(RingQueueTest, PopFrontReleasesSlot)
+{
+    RingQueue<std::shared_ptr<int>> queue(2);
+    auto item = std::make_shared<int>(42);
+
+    queue.PushBack(item);
+    EXPECT_EQ(item.use_count(), 2);
+
+    std::shared_ptr<int> out;
+    queue.PopFront(out);
+    EXPECT_EQ(*out, 42);
+    out.reset();
+    EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(RingQueueTest, Clear)
+{
+    RingQueue<std::shared_ptr<int>> queue(2);
+    auto item = std::make_shared<int>(42);
+
+    queue.PushBack(item);
+    queue.Clear();
+    EXPECT_EQ(queue.GetSize(), 0);
+    EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(RingQueueTest, PushFront)
+{
+    RingQueue<int> queue(3);
+
+    EXPECT_EQ(queue.PushFront(2), true);
+    EXPECT_EQ(queue.PushBack(3), true);
+    EXPECT_EQ(queue.PushFront(1), true);
+    EXPECT_EQ(queue.PushFront(0), false);
+    EXPECT_EQ(queue.GetSize(), 3);
+
+    int out = 0;
+    for (int i = 1; i <= 3; i++) {
+        EXPECT_EQ(queue.PopFront(out), true);
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_EQ(queue.IsEmpty(), true);
+}
+
+TEST(RingQueueTest, Erase)
+{
+    RingQueue<int> queue(4);
+
+    // Make the items wrap around the end of the buffer
+    queue.PushBack(0);
+    queue.PushBack(0);
+    int out = 0;
+    queue.PopFront(out);
+    queue.PopFront(out);
+    for (int i = 1; i <= 4; i++) {
+        queue.PushBack(i);
+    }
+
+    queue.Erase(1);
+    EXPECT_EQ(queue.GetSize(), 3);
+    EXPECT_EQ(queue[0], 1);
+    EXPECT_EQ(queue[1], 3);
+    EXPECT_EQ(queue[2], 4);
+
+    queue.Erase(2);
+    EXPECT_EQ(queue.GetSize(), 2);
+    EXPECT_EQ(queue[1], 3);
+
+    queue.Erase(0);
+    EXPECT_EQ(queue.GetSize(), 1);
+    EXPECT_EQ(queue.Front(), 3);
+
+    EXPECT_EQ(queue.PushBack(5), true);
+    EXPECT_EQ(queue[1], 5);
+}
+
+TEST(RingQueueTest, MoveConstructor)
+{
+    RingQueue<int> queue1(4);
+    queue1.PushBack(1);
+
+    RingQueue<int> queue2(std::move(queue1));
+    EXPECT_EQ(queue2.GetSize(), 1);
+    EXPECT_EQ(queue2.Front(), 1);
+
+    EXPECT_EQ(queue1.GetCapacity(), 0);
+    EXPECT_EQ(queue1.GetSize(), 0);
+}
+
+void TestRingQueue()
+{
+    Construction();
+    PushBackAndPopFront();
+    PushBackOverflow();
+    WrapAround();
+    PopFrontReleasesSlot();
+    Clear();
+    PushFront();
+    Erase();
+    MoveConstructor();
+}
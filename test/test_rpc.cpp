@@ -0,0 +1,243 @@
+#include "private/test_defs.hpp"
+#include <deque>
+#include <vector>
+#include <stpp/rpc.hpp>
+using namespace stpp::rpc;
+
+namespace
+{
+    // Packets sent by one endpoint are queued for the other and delivered by Pump(), like a link with no loss
+    struct LoopbackTransport {
+        struct Packet {
+            std::vector<uint8_t> storage;
+            uint8_t *data = nullptr;
+        };
+
+        std::deque<std::vector<uint8_t>> *outbox;
+        bool is_out_of_memory = false;
+
+        Packet AllocatePacket(std::size_t max_length)
+        {
+            Packet packet;
+            if (!is_out_of_memory) {
+                packet.storage.resize(max_length);
+                packet.data = packet.storage.data();
+            }
+            return packet;
+        }
+
+        bool SendPacket(Packet &&packet, std::size_t length)
+        {
+            packet.storage.resize(length);
+            outbox->push_back(std::move(packet.storage));
+            return true;
+        }
+    };
+
+    using TestEndpoint = Endpoint<LoopbackTransport>;
+
+    struct Link {
+        std::deque<std::vector<uint8_t>> to_server;
+        std::deque<std::vector<uint8_t>> to_client;
+        TestEndpoint client{LoopbackTransport{&to_server}, 64, 4, 4};
+        TestEndpoint server{LoopbackTransport{&to_client}, 64, 4, 4};
+
+        void Pump()
+        {
+            while (!to_server.empty() || !to_client.empty()) {
+                while (!to_server.empty()) {
+                    auto packet = std::move(to_server.front());
+                    to_server.pop_front();
+                    server.OnPacket(packet.data(), packet.size());
+                }
+                while (!to_client.empty()) {
+                    auto packet = std::move(to_client.front());
+                    to_client.pop_front();
+                    client.OnPacket(packet.data(), packet.size());
+                }
+            }
+        }
+    };
+
+    constexpr uint8_t kAdd  = 0;
+    constexpr uint8_t kEcho = 1;
+    constexpr uint8_t kFail = 2;
+
+    void RegisterMethods(TestEndpoint &server)
+    {
+        server.Register(kAdd, [](Reader &args, Writer &reply) {
+            auto a = args.Read<int32_t>();
+            auto b = args.Read<int32_t>();
+            if (args.HasError()) {
+                reply.SetError();
+                return;
+            }
+            reply.Write<int32_t>(a + b);
+        });
+        server.Register(kEcho, [](Reader &args, Writer &reply) {
+            auto length = args.GetRemaining();
+            reply.WriteBytes(args.ReadBytes(length), length);
+        });
+        server.Register(kFail, [](Reader &, Writer &reply) {
+            reply.Write<uint32_t>(1);
+            reply.SetError();
+        });
+    }
+}
+
+TEST(RpcTest, CallAndStatus)
+{
+    Link link;
+    RegisterMethods(link.server);
+
+    int32_t sum = 0;
+    auto ok     = link.client.AsyncCall(
+        kAdd, [](Writer &args) { args.Write<int32_t>(40); args.Write<int32_t>(2); },
+        [&](Status status, Reader &result) {
+            EXPECT_EQ(status, Status::kOk);
+            sum = result.Read<int32_t>();
+        });
+    EXPECT_EQ(ok, true);
+    EXPECT_EQ(link.client.GetPendingCount(), 1);
+    link.Pump();
+    EXPECT_EQ(sum, 42);
+    EXPECT_EQ(link.client.GetPendingCount(), 0);
+
+    std::vector<Status> statuses;
+    auto on_result = [&](Status status, Reader &result) {
+        statuses.push_back(status);
+        EXPECT_EQ(result.GetRemaining(), status == Status::kOk ? 57 : 0); // Failed calls carry no reply
+    };
+    std::vector<uint8_t> largest(57); // 64 - 5 byte header - 2 byte CRC
+    link.client.AsyncCall(kFail, nullptr, 0, on_result);
+    link.client.AsyncCall(3, nullptr, 0, on_result);   // Valid id, no handler
+    link.client.AsyncCall(200, nullptr, 0, on_result); // Out of range
+    link.client.AsyncCall(kEcho, largest.data(), largest.size(), on_result);
+    link.Pump();
+    EXPECT_EQ(statuses, (std::vector<Status>{Status::kHandlerError, Status::kUnknownMethod, Status::kUnknownMethod, Status::kOk}));
+
+    // Arguments that do not fit are rejected before anything is sent
+    std::vector<uint8_t> big(58);
+    EXPECT_EQ(link.client.AsyncCall(kEcho, big.data(), big.size(), on_result), false);
+    EXPECT_EQ(link.client.GetPendingCount(), 0);
+    EXPECT_EQ(link.to_server.empty(), true);
+}
+
+TEST(RpcTest, PipelinedCalls)
+{
+    Link link;
+    RegisterMethods(link.server);
+
+    // Queue every request before any reply is delivered, then check each reply reached its own callback
+    int32_t results[4] = {};
+    uint16_t seqs[4];
+    for (int32_t i = 0; i < 4; i++) {
+        auto ok = link.client.AsyncCall(
+            kAdd, [i](Writer &args) { args.Write<int32_t>(i); args.Write<int32_t>(100); },
+            [&results, i](Status status, Reader &result) {
+                EXPECT_EQ(status, Status::kOk);
+                results[i] = result.Read<int32_t>();
+            },
+            &seqs[i]);
+        EXPECT_EQ(ok, true);
+    }
+    EXPECT_NE(seqs[0], seqs[1]);
+
+    // The table is full
+    EXPECT_EQ(link.client.AsyncCall(kAdd, nullptr, 0, nullptr), false);
+
+    // Deliver the requests, then the replies in reverse order
+    while (!link.to_server.empty()) {
+        auto packet = std::move(link.to_server.front());
+        link.to_server.pop_front();
+        link.server.OnPacket(packet.data(), packet.size());
+    }
+    while (!link.to_client.empty()) {
+        auto packet = std::move(link.to_client.back());
+        link.to_client.pop_back();
+        link.client.OnPacket(packet.data(), packet.size());
+    }
+
+    for (int32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(results[i], i + 100);
+    }
+    EXPECT_EQ(link.client.GetPendingCount(), 0);
+}
+
+TEST(RpcTest, ZeroCopyArguments)
+{
+    Link link;
+
+    // The handler sees the arguments in the received packet and writes the reply into the transmit packet
+    const uint8_t *seen_args = nullptr;
+    link.server.Register(kEcho, [&](Reader &args, Writer &reply) {
+        seen_args  = args.ReadBytes(4);
+        auto bytes = reply.Reserve(4);
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = static_cast<uint8_t>(seen_args[i] + 1);
+        }
+    });
+
+    uint8_t arg[4] = {1, 2, 3, 4};
+    std::vector<uint8_t> reply;
+    link.client.AsyncCall(kEcho, arg, sizeof(arg), [&](Status, Reader &result) {
+        reply.assign(result.GetData(), result.GetData() + result.GetLength());
+    });
+
+    auto request = link.to_server.front();
+    link.to_server.clear();
+    link.server.OnPacket(request.data(), request.size());
+    EXPECT_EQ(seen_args, request.data() + TestEndpoint::kHeaderLength);
+
+    link.Pump();
+    EXPECT_EQ(reply, (std::vector<uint8_t>{2, 3, 4, 5}));
+}
+
+TEST(RpcTest, CorruptionAndCancel)
+{
+    Link link;
+    RegisterMethods(link.server);
+
+    int calls = 0;
+    Status last_status;
+    auto on_result = [&](Status status, Reader &) {
+        calls++;
+        last_status = status;
+    };
+
+    // A corrupted request is dropped, the caller cancels and a late duplicate reply is ignored
+    uint16_t seq;
+    link.client.AsyncCall(kEcho, "abc", 3, on_result, &seq);
+    auto request = link.to_server.front();
+    link.to_server.clear();
+    request[6] ^= 0x01;
+    link.server.OnPacket(request.data(), request.size());
+    link.server.OnPacket(request.data(), 3);
+    EXPECT_EQ(link.server.GetErrorCount(), 2);
+    EXPECT_EQ(link.to_client.empty(), true);
+
+    EXPECT_EQ(link.client.Cancel(seq), true);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(last_status, Status::kCancelled);
+    EXPECT_EQ(link.client.Cancel(seq), false);
+
+    request[6] ^= 0x01;
+    link.server.OnPacket(request.data(), request.size());
+    link.Pump();
+    EXPECT_EQ(calls, 1);
+
+    // No memory for the reply
+    link.server.GetTransport().is_out_of_memory = true;
+    link.client.AsyncCall(kEcho, "abc", 3, on_result);
+    link.Pump();
+    EXPECT_EQ(link.server.GetErrorCount(), 3);
+    EXPECT_EQ(link.client.GetPendingCount(), 1);
+}
+
+void TestRpc()
+{
+    CallAndStatus();
+    PipelinedCalls();
+    ZeroCopyArguments();
+    CorruptionAndCancel();
+}
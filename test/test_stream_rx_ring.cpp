@@ -0,0 +1,54 @@
+#include "private/test_defs.hpp"
+#include <stpp/device_framework/private_include/stream_rx_ring.hpp>
+using namespace stpp::device_framework_internal;
+
+// Simulate DMA writing length bytes, published at most half a ring at a time like the half/full/idle interrupts
+static void Produce(StreamRxRing &ring, std::size_t &write_pos, std::size_t length)
+{
+    auto half = ring.GetCapacity() / 2;
+    while (length > 0) {
+        auto step = length < half ? length : half;
+        write_pos = (write_pos + step) & (ring.GetCapacity() - 1);
+        ring.Publish(write_pos);
+        length -= step;
+    }
+}
+
+TEST(StreamRxRingTest, MaxReadLengthIsServable)
+{
+    StreamRxRing ring(16);
+    std::size_t write_pos = 0;
+    EXPECT_EQ(ring.GetMaxReadLength(), 15);
+
+    // The longest accepted read can always be satisfied
+    Produce(ring, write_pos, ring.GetMaxReadLength());
+    EXPECT_EQ(ring.GetSize(), 15);
+    EXPECT_EQ(ring.GetOverflowCount(), 0);
+
+    uint8_t data[16];
+    EXPECT_EQ(ring.Read(data, sizeof(data)), 15);
+    EXPECT_EQ(ring.GetSize(), 0);
+}
+
+TEST(StreamRxRingTest, FullCapacityOverflows)
+{
+    StreamRxRing ring(16);
+    std::size_t write_pos = 0;
+
+    // A full ring of unread data is indistinguishable from an overwrite and is dropped, so a read of exactly
+    // the capacity could never complete
+    Produce(ring, write_pos, ring.GetCapacity());
+    EXPECT_EQ(ring.GetSize(), 0);
+    EXPECT_EQ(ring.GetOverflowCount(), 1);
+
+    // Reception continues normally afterwards
+    Produce(ring, write_pos, 3);
+    EXPECT_EQ(ring.GetSize(), 3);
+    EXPECT_EQ(ring.GetOverflowCount(), 1);
+}
+
+void TestStreamRxRing()
+{
+    MaxReadLengthIsServable();
+    FullCapacityOverflows();
+}